@@ -0,0 +1,41 @@
+#include "headers/Arena.h"
+#include <algorithm>
+#include <iterator>
+
+Arena::~Arena()
+{
+   for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+      it->destroy(it->object);
+   }
+}
+
+void* Arena::allocate(std::size_t size, std::size_t alignment)
+{
+   std::size_t start = (offset + alignment - 1) & ~(alignment - 1);
+   if (start + size > capacity)
+   {
+      capacity = std::max(BLOCK_SIZE, size + alignment);
+      blocks.push_back(std::unique_ptr<std::byte[]>(new std::byte[capacity])); // * Not make_unique, it would zero the whole block
+      offset = 0;
+      start = 0;
+   }
+
+   offset = start + size;
+   return blocks.back().get() + start;
+}
+
+// * Allocation goes on in other's last block, the rest of this arena's current block is not used anymore
+void Arena::absorb(Arena& other)
+{
+   if (other.blocks.empty()) {
+      return;
+   }
+   std::move(other.blocks.begin(), other.blocks.end(), std::back_inserter(blocks));
+   destructors.insert(destructors.end(), other.destructors.begin(), other.destructors.end());
+   offset = other.offset;
+   capacity = other.capacity;
+
+   other.blocks.clear();
+   other.destructors.clear();
+   other.offset = other.capacity = BLOCK_SIZE;
+}
\ No newline at end of file
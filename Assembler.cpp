@@ -0,0 +1,174 @@
+#include "headers/Assembler.h"
+#include <cstring>
+
+void Assembler::emit(std::initializer_list<std::uint8_t> bytes)
+{
+   code.insert(code.end(), bytes);
+}
+
+void Assembler::emit32(std::int32_t value)
+{
+   std::uint8_t bytes[4];
+   std::memcpy(bytes, &value, 4);
+   code.insert(code.end(), bytes, bytes + 4);
+}
+
+void Assembler::emit64(std::uint64_t value)
+{
+   std::uint8_t bytes[8];
+   std::memcpy(bytes, &value, 8);
+   code.insert(code.end(), bytes, bytes + 8);
+}
+
+// * rbx is saved at [rbp - 8], the slots come after it
+std::int32_t Assembler::slot_offset(int slot)
+{
+   return -16 - 8 * slot;
+}
+
+void Assembler::prologue()
+{
+   emit({0x55});                         // push rbp
+   emit({0x48, 0x89, 0xE5});             // mov rbp, rsp
+   emit({0x53});                         // push rbx
+   emit({0x48, 0x81, 0xEC});             // sub rsp, frame size
+   frame_size_position = code.size();
+   emit32(0);
+   emit({0x48, 0x89, 0xFB});             // mov rbx, rdi
+}
+
+// * Entered with rsp 8 below a 16 byte boundary, after pushing rbp and rbx the frame has to be an odd number of 8 byte words
+void Assembler::set_frame_size(int slot_count)
+{
+   std::int32_t frame_size = 8 * (slot_count % 2 == 0 ? slot_count + 1 : slot_count);
+   std::memcpy(&code[frame_size_position], &frame_size, 4);
+}
+
+void Assembler::epilogue()
+{
+   emit({0x48, 0x8B, 0x5D, 0xF8});       // mov rbx, [rbp - 8]
+   emit({0xC9});                         // leave
+   emit({0xC3});                         // ret
+}
+
+void Assembler::load_argument(int index)
+{
+   emit({0xF2, 0x0F, 0x10, 0x86}); emit32(8 * index);      // movsd xmm0, [rsi + 8 * index]
+}
+
+void Assembler::load_slot(int slot)
+{
+   emit({0xF2, 0x0F, 0x10, 0x85}); emit32(slot_offset(slot)); // movsd xmm0, [rbp + offset]
+}
+
+void Assembler::store_slot(int slot)
+{
+   emit({0xF2, 0x0F, 0x11, 0x85}); emit32(slot_offset(slot)); // movsd [rbp + offset], xmm0
+}
+
+void Assembler::load_constant(double value)
+{
+   std::uint64_t bits;
+   std::memcpy(&bits, &value, 8);
+   emit({0x48, 0xB8}); emit64(bits);     // mov rax, bits
+   emit({0x66, 0x48, 0x0F, 0x6E, 0xC0}); // movq xmm0, rax
+}
+
+void Assembler::push()
+{
+   grow_stack(8);
+   emit({0xF2, 0x0F, 0x11, 0x04, 0x24}); // movsd [rsp], xmm0
+}
+
+void Assembler::pop_operands()
+{
+   emit({0x66, 0x0F, 0x28, 0xC8});       // movapd xmm1, xmm0
+   emit({0xF2, 0x0F, 0x10, 0x04, 0x24}); // movsd xmm0, [rsp]
+   shrink_stack(8);
+}
+
+void Assembler::sse(std::uint8_t prefix, std::uint8_t opcode)
+{
+   emit({prefix, 0x0F, opcode, 0xC1});
+}
+
+void Assembler::add()      { sse(0xF2, 0x58); }
+void Assembler::subtract() { sse(0xF2, 0x5C); }
+void Assembler::multiply() { sse(0xF2, 0x59); }
+void Assembler::divide()   { sse(0xF2, 0x5E); }
+
+void Assembler::negate()
+{
+   emit({0x48, 0xB8}); emit64(0x8000000000000000ull); // mov rax, sign bit
+   emit({0x66, 0x48, 0x0F, 0x6E, 0xC8});              // movq xmm1, rax
+   sse(0x66, 0x57);                                   // xorpd xmm0, xmm1
+}
+
+void Assembler::compare(bool swapped)
+{
+   if (swapped) {
+      emit({0x66, 0x0F, 0x2E, 0xC8});    // ucomisd xmm1, xmm0
+   }
+   else {
+      sse(0x66, 0x2E);                   // ucomisd xmm0, xmm1
+   }
+}
+
+void Assembler::grow_stack(int bytes)
+{
+   emit({0x48, 0x81, 0xEC}); emit32(bytes); // sub rsp, bytes
+}
+
+void Assembler::shrink_stack(int bytes)
+{
+   emit({0x48, 0x81, 0xC4}); emit32(bytes); // add rsp, bytes
+}
+
+void Assembler::call(const void* function, const void* argument)
+{
+   emit({0x48, 0x89, 0xDF});             // mov rdi, rbx
+   emit({0x48, 0xBE}); emit64(reinterpret_cast<std::uint64_t>(argument)); // mov rsi, argument
+   emit({0x48, 0x89, 0xE2});             // mov rdx, rsp
+   emit({0x48, 0xB8}); emit64(reinterpret_cast<std::uint64_t>(function)); // mov rax, function
+   emit({0xFF, 0xD0});                   // call rax
+}
+
+void Assembler::jump_if_flag(int offset, Label& label)
+{
+   emit({0x80, 0x7B, static_cast<std::uint8_t>(offset), 0x00}); // cmp byte [rbx + offset], 0
+   jump_if(NOT_EQUAL, label);
+}
+
+void Assembler::jump(Label& label)
+{
+   emit({0xE9});
+   emit_target(label);
+}
+
+void Assembler::jump_if(Condition condition, Label& label)
+{
+   emit({0x0F, static_cast<std::uint8_t>(0x80 | condition)});
+   emit_target(label);
+}
+
+// * rel32 operands are relative to the end of the instruction, which they always end
+void Assembler::emit_target(Label& label)
+{
+   if (label.position >= 0) {
+      emit32(label.position - static_cast<int>(code.size() + 4));
+      return;
+   }
+   label.patches.push_back(code.size());
+   emit32(0);
+}
+
+void Assembler::bind(Label& label)
+{
+   label.position = code.size();
+   for (int patch : label.patches)
+   {
+      std::int32_t distance = label.position - (patch + 4);
+      std::memcpy(&code[patch], &distance, 4);
+   }
+   label.patches.clear();
+}
\ No newline at end of file
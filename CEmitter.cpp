@@ -0,0 +1,452 @@
+#include "headers/CEmitter.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+std::string CEmitter::emit(const std::vector<Stmt*>& statements)
+{
+   walk(statements);
+
+   locals.clear();
+   function_count = 0;
+   globals.clear();
+   constants.clear();
+   out.str("");
+   walk(statements);
+
+   std::ostringstream program;
+   program << C_RUNTIME << "\n";
+   globals.insert("clock");
+   for (const std::string& name : globals) {
+      program << "static Global g_" << name << "{\"" << name << "\"};\n";
+   }
+   for (const std::string& constant : constants) {
+      program << constant << "\n";
+   }
+   program << "\nstatic void lox_main()\n{\n" << out.str() << "}\n\n"
+           << "int main()\n{\n"
+           << "   g_clock.define(Value(Tag::NATIVE, std::make_shared<Native>(0, lox::clock)));\n"
+           << "   try {\n"
+           << "      lox_main();\n"
+           << "   }\n"
+           << "   catch (const RuntimeError& error) {\n"
+           << "      std::cerr << error.message << std::endl << \"[line \" << error.line << \"]\\n\";\n"
+           << "      return 70;\n"
+           << "   }\n"
+           << "   return 0;\n"
+           << "}\n";
+   return program.str();
+}
+
+void CEmitter::walk(const std::vector<Stmt*>& statements)
+{
+   for (Stmt* stmt : statements) {
+      emit(stmt);
+   }
+}
+
+std::string CEmitter::emit(Expr* expr)
+{
+   expr->accept(*this);
+   return std::move(expr_result);
+}
+
+void CEmitter::emit(Stmt* stmt)
+{
+   stmt->accept(*this);
+}
+
+std::ostream& CEmitter::line()
+{
+   return out << std::string(indent * 3, ' ');
+}
+
+// * Locals are declared in the order the Resolver gave them slots, so the first walk and the second agree on the indices
+int CEmitter::declare(std::string_view name)
+{
+   int local = locals.size();
+   locals.push_back(Local{"l" + std::to_string(local) + "_" + std::string(name), function});
+   if (captured.size() < locals.size()) {
+      captured.push_back(false);
+   }
+   scopes.back().push_back(local);
+   return local;
+}
+
+std::string CEmitter::declaration(int local, const std::string& value)
+{
+   if (captured[local]) {
+      return "auto " + locals[local].name + " = std::make_shared<Value>(" + value + ");";
+   }
+   return "Value " + locals[local].name + " = " + value + ";";
+}
+
+std::string CEmitter::access(const Resolution& resolution)
+{
+   return access(scopes[scopes.size() - 1 - resolution.depth][resolution.slot]);
+}
+
+std::string CEmitter::access(int local)
+{
+   if (locals[local].function != function) {
+      captured[local] = true;
+   }
+   if (captured[local]) {
+      return "(*" + locals[local].name + ")";
+   }
+   return locals[local].name;
+}
+
+std::string CEmitter::global(const Token& name)
+{
+   globals.emplace(name.lexeme);
+   return "g_" + std::string(name.lexeme);
+}
+
+std::string CEmitter::function_value(Function* declaration_node, FunctionType type)
+{
+   int enclosing_function = function;
+   FunctionType enclosing_type = function_type;
+   function = ++function_count;
+   function_type = type;
+   std::ostringstream body;
+   std::swap(out, body);
+   ++indent;
+
+   scopes.emplace_back();
+   if (type == FunctionType::METHOD or type == FunctionType::INITIALIZER) {
+      line() << declaration(declare("this"), "self") << "\n";
+   }
+   for (std::size_t i = 0; i < declaration_node->params.size(); ++i) {
+      line() << declaration(declare(declaration_node->params[i]->lexeme), "arguments[" + std::to_string(i) + "]") << "\n";
+   }
+   walk(declaration_node->body);
+   line() << (type == FunctionType::INITIALIZER ? "return self;" : "return Value();") << "\n";
+   scopes.pop_back();
+
+   --indent;
+   std::swap(out, body);
+   function = enclosing_function;
+   function_type = enclosing_type;
+   return "make_function(\"" + std::string(declaration_node->name.lexeme) + "\", " + std::to_string(declaration_node->params.size())
+        + ", [=]([[maybe_unused]] const Value& self, [[maybe_unused]] std::vector<Value>& arguments) -> Value {\n" + body.str() + std::string(indent * 3, ' ') + "})";
+}
+
+// * Exact for every double: non-finite values and -0 have no literal, they are written as their bits
+std::string CEmitter::number(double value)
+{
+   char text[64];
+   if (std::isfinite(value) and not (value == 0 and std::signbit(value))) {
+      std::snprintf(text, sizeof text, "num(%.17g)", value);
+   }
+   else {
+      std::uint64_t bits;
+      std::memcpy(&bits, &value, sizeof bits);
+      std::snprintf(text, sizeof text, "num_bits(0x%016llxULL)", static_cast<unsigned long long>(bits));
+   }
+   return text;
+}
+
+// * String literals are built once, before the program runs
+std::string CEmitter::string_constant(const std::string& value)
+{
+   std::string literal;
+   for (unsigned char c : value)
+   {
+      switch (c)
+      {
+         case '\\': literal += "\\\\"; break;
+         case '"':  literal += "\\\""; break;
+         case '?':  literal += "\\?";  break; // * So "??=" and the like never form a trigraph
+         case '\n': literal += "\\n";  break;
+         case '\t': literal += "\\t";  break;
+         case '\r': literal += "\\r";  break;
+         default:
+            if (c < 0x20 or c >= 0x7f) {
+               char escape[8];
+               std::snprintf(escape, sizeof escape, "\\%03o", c);
+               literal += escape;
+            }
+            else {
+               literal += c;
+            }
+      }
+   }
+   std::string name = "k" + std::to_string(constants.size());
+   constants.push_back("static const Value " + name + " = str(\"" + literal + "\");");
+   return name;
+}
+
+Value CEmitter::visit_BinaryExpr(Binary* expr)
+{
+   std::string left  = emit(expr->left);
+   std::string right = emit(expr->right);
+   std::string operands = "Operands{" + right + ", " + left + "}";
+   std::string at = ", " + std::to_string(expr->op.line) + ")";
+
+   switch (expr->op.type)
+   {
+      case PLUS:          expr_result = "add(" + operands + at;           break;
+      case MINUS:         expr_result = "subtract(" + operands + at;      break;
+      case STAR:          expr_result = "multiply(" + operands + at;      break;
+      case SLASH:         expr_result = "divide(" + operands + at;        break;
+      case GREATER:       expr_result = "greater(" + operands + at;       break;
+      case GREATER_EQUAL: expr_result = "greater_equal(" + operands + at; break;
+      case LESS:          expr_result = "less(" + operands + at;          break;
+      case LESS_EQUAL:    expr_result = "less_equal(" + operands + at;    break;
+      case EQUAL_EQUAL:   expr_result = "equal(" + operands + ")";        break;
+      case BANG_EQUAL:    expr_result = "not_equal(" + operands + ")";    break;
+      default:            expr_result = "Value()";                        break;
+   }
+   return nullptr;
+}
+
+Value CEmitter::visit_GroupExpr(Group* expr)
+{
+   expr_result = emit(expr->expr_in);
+   return nullptr;
+}
+
+Value CEmitter::visit_LiteralExpr(Literal* expr)
+{
+   const Value& value = expr->value;
+   if (value.is_bool()) {
+      expr_result = value.as_bool() ? "Value(true)" : "Value(false)"; }
+   else if (value.is_number()) {
+      expr_result = number(value.as_number()); }
+   else if (value.is_string()) {
+      expr_result = string_constant(value.as_string()); }
+   else {
+      expr_result = "Value()"; }
+   return nullptr;
+}
+
+Value CEmitter::visit_UnaryExpr(Unary* expr)
+{
+   std::string right = emit(expr->right);
+   if (expr->op.type == MINUS) {
+      expr_result = "negate(" + right + ", " + std::to_string(expr->op.line) + ")";
+   }
+   else {
+      expr_result = "logical_not(" + right + ")";
+   }
+   return nullptr;
+}
+
+Value CEmitter::visit_VariableExpr(Variable* expr)
+{
+   if (expr->resolution.is_local()) {
+      expr_result = access(expr->resolution);
+   }
+   else {
+      expr_result = global(expr->name) + ".get(" + std::to_string(expr->name.line) + ")";
+   }
+   return nullptr;
+}
+
+Value CEmitter::visit_AssignExpr(Assign* expr)
+{
+   std::string value = emit(expr->value);
+   if (expr->resolution.is_local()) {
+      expr_result = "(" + access(expr->resolution) + " = " + value + ")";
+   }
+   else {
+      expr_result = global(expr->name) + ".assign(" + value + ", " + std::to_string(expr->name.line) + ")";
+   }
+   return nullptr;
+}
+
+Value CEmitter::visit_LogicalExpr(Logical* expr)
+{
+   std::string left  = emit(expr->left);
+   std::string right = emit(expr->right);
+   std::string operation = expr->op.type == OR ? "logical_or(" : "logical_and(";
+   expr_result = operation + left + ", [&]() -> Value { return " + right + "; })";
+   return nullptr;
+}
+
+Value CEmitter::visit_CallExpr(Call* expr)
+{
+   std::string callee = emit(expr->calle);
+   std::string arguments;
+   for (Expr* argument : expr->arguements) {
+      arguments += (arguments.empty() ? "" : ", ") + emit(argument);
+   }
+   expr_result = "call(Invocation{" + callee + ", {" + arguments + "}}, " + std::to_string(expr->paren.line) + ")";
+   return nullptr;
+}
+
+Value CEmitter::visit_GetExpr(Get* expr)
+{
+   std::string object = emit(expr->object);
+   expr_result = "get_property(" + object + ", \"" + std::string(expr->name.lexeme) + "\", " + std::to_string(expr->name.line) + ")";
+   return nullptr;
+}
+
+Value CEmitter::visit_SetExpr(Set* expr)
+{
+   std::string object = emit(expr->object);
+   std::string value  = emit(expr->value);
+   expr_result = "set_property(Assignment{check_instance(" + object + ", " + std::to_string(expr->name.line) + "), "
+               + value + "}, \"" + std::string(expr->name.lexeme) + "\")";
+   return nullptr;
+}
+
+Value CEmitter::visit_ThisExpr(This* expr)
+{
+   expr_result = access(expr->resolution);
+   return nullptr;
+}
+
+// * "this" is in the method's scope, right inside the one holding "super"
+Value CEmitter::visit_SuperExpr(Super* expr)
+{
+   std::string superclass = access(expr->resolution);
+   std::string self = access(Resolution{expr->resolution.depth - 1, 0});
+   expr_result = "get_super(" + superclass + ", " + self + ", \"" + std::string(expr->method.lexeme) + "\", " + std::to_string(expr->method.line) + ")";
+   return nullptr;
+}
+
+Completion CEmitter::visit_ExpressionStmt(Expression* stmt)
+{
+   line() << emit(stmt->expression) << ";\n";
+   return Completion{};
+}
+
+Completion CEmitter::visit_PrintStmt(Print* stmt)
+{
+   line() << "print(" << emit(stmt->expression) << ");\n";
+   return Completion{};
+}
+
+Completion CEmitter::visit_VarStmt(Var* stmt)
+{
+   std::string value = stmt->initializer != nullptr ? emit(stmt->initializer) : "Value()";
+   if (scopes.empty()) {
+      line() << global(stmt->name) << ".define(" << value << ");\n";
+   }
+   else {
+      line() << declaration(declare(stmt->name.lexeme), value) << "\n";
+   }
+   return Completion{};
+}
+
+Completion CEmitter::visit_BlockStmt(Block* stmt)
+{
+   line() << "{\n";
+   ++indent;
+   scopes.emplace_back();
+   walk(stmt->statements);
+   scopes.pop_back();
+   --indent;
+   line() << "}\n";
+   return Completion{};
+}
+
+Completion CEmitter::visit_IfStmt(If* stmt)
+{
+   line() << "if (truthy(" << emit(stmt->condition) << ")) {\n";
+   ++indent;
+   emit(stmt->then_branch);
+   --indent;
+   if (stmt->else_branch != nullptr)
+   {
+      line() << "}\n";
+      line() << "else {\n";
+      ++indent;
+      emit(stmt->else_branch);
+      --indent;
+   }
+   line() << "}\n";
+   return Completion{};
+}
+
+Completion CEmitter::visit_WhileStmt(While* stmt)
+{
+   line() << "while (truthy(" << emit(stmt->condition) << ")) {\n";
+   ++indent;
+   emit(stmt->body);
+   --indent;
+   line() << "}\n";
+   return Completion{};
+}
+
+// * The name is declared before the body is walked, so a local function can call itself through its cell
+Completion CEmitter::visit_FunctionStmt(Function* stmt)
+{
+   if (scopes.empty()) {
+      std::string value = function_value(stmt, FunctionType::FUNCTION);
+      line() << global(stmt->name) << ".define(" << value << ");\n";
+      return Completion{};
+   }
+
+   int local = declare(stmt->name.lexeme);
+   std::string value = function_value(stmt, FunctionType::FUNCTION);
+   if (captured[local]) {
+      line() << declaration(local, "") << "\n";
+      line() << access(local) << " = " << value << ";\n";
+   }
+   else {
+      line() << declaration(local, value) << "\n";
+   }
+   return Completion{};
+}
+
+Completion CEmitter::visit_ReturnStmt(Return* stmt)
+{
+   if (function_type == FunctionType::INITIALIZER) {
+      line() << "return self;\n";
+   }
+   else if (stmt->value != nullptr) {
+      line() << "return " << emit(stmt->value) << ";\n";
+   }
+   else {
+      line() << "return Value();\n";
+   }
+   return Completion{};
+}
+
+Completion CEmitter::visit_ClassStmt(Class* stmt)
+{
+   int local = -1;
+   if (scopes.empty()) {
+      line() << global(stmt->name) << ".define(Value());\n";
+   }
+   else {
+      local = declare(stmt->name.lexeme);
+      line() << declaration(local, "Value()") << "\n";
+   }
+
+   line() << "{\n";
+   ++indent;
+   std::string superclass = "Value()";
+   if (stmt->superclass != nullptr) {
+      line() << "Value superclass = check_superclass(" << emit(stmt->superclass) << ", " << stmt->superclass->name.line << ");\n";
+      superclass = "superclass";
+   }
+   line() << "std::shared_ptr<Class> lox_class = make_class(\"" << stmt->name.lexeme << "\", " << superclass << ");\n";
+
+   if (stmt->superclass != nullptr) {
+      scopes.emplace_back();
+      line() << declaration(declare("super"), "superclass") << "\n";
+   }
+   for (Function* method : stmt->methods) {
+      FunctionType type = method->name.lexeme == "init" ? FunctionType::INITIALIZER : FunctionType::METHOD;
+      line() << "lox_class->add_method(\"" << method->name.lexeme << "\", " << function_value(method, type) << ");\n";
+   }
+   if (stmt->superclass != nullptr) {
+      scopes.pop_back();
+   }
+
+   if (local < 0) {
+      line() << global(stmt->name) << ".define(Value(Tag::CLASS, lox_class));\n";
+   }
+   else {
+      line() << access(local) << " = Value(Tag::CLASS, lox_class);\n";
+   }
+   --indent;
+   line() << "}\n";
+   return Completion{};
+}
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "headers/CEmitter.h"
+
+// * Mirrors the interpreter's Value, Interpreter and LoxClass/LoxInstance/LoxFunction semantics, messages and formatting included
+const char* const C_RUNTIME = R"runtime(#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lox {
+
+struct RuntimeError {
+   int line;
+   std::string message;
+};
+
+enum class Tag { NIL, BOOL, NUMBER, STRING, NATIVE, FUNCTION, CLASS, INSTANCE };
+
+struct Object {
+   virtual ~Object() = default;
+   virtual std::string to_string() const = 0;
+};
+
+struct Value {
+   Tag tag = Tag::NIL;
+   bool boolean = false;
+   double number = 0;
+   std::shared_ptr<Object> object;
+
+   Value() = default;
+   explicit Value(bool boolean) : tag(Tag::BOOL), boolean(boolean) {}
+   Value(Tag tag, std::shared_ptr<Object> object) : tag(tag), object(std::move(object)) {}
+
+   template <typename T>
+   T* as() const { return static_cast<T*>(object.get()); }
+};
+
+inline Value num(double number)
+{
+   Value value;
+   value.tag = Tag::NUMBER;
+   value.number = number;
+   return value;
+}
+
+inline Value num_bits(std::uint64_t bits)
+{
+   double number;
+   std::memcpy(&number, &bits, sizeof number);
+   return num(number);
+}
+
+struct String : Object {
+   std::string value;
+   explicit String(std::string value) : value(std::move(value)) {}
+   std::string to_string() const override { return value; }
+};
+
+inline Value str(std::string text) { return Value(Tag::STRING, std::make_shared<String>(std::move(text))); }
+
+struct Native : Object {
+   int arity;
+   Value (*run)();
+   Native(int arity, Value (*run)()) : arity(arity), run(run) {}
+   std::string to_string() const override { return "<native fn>"; }
+};
+
+using Code = std::function<Value(const Value& self, std::vector<Value>& arguments)>;
+
+struct Function : Object {
+   std::string name;
+   int arity;
+   std::shared_ptr<const Code> code;
+   Value receiver; // * The instance of a bound method, passed to the code as self
+   Function(std::string name, int arity, std::shared_ptr<const Code> code, Value receiver)
+      : name(std::move(name)), arity(arity), code(std::move(code)), receiver(std::move(receiver)) {}
+   std::string to_string() const override { return "<fn " + name + ">"; }
+};
+
+inline Value make_function(std::string name, int arity, Code code)
+{
+   return Value(Tag::FUNCTION, std::make_shared<Function>(std::move(name), arity, std::make_shared<const Code>(std::move(code)), Value()));
+}
+
+inline Value bind(const Function& method, const Value& instance)
+{
+   return Value(Tag::FUNCTION, std::make_shared<Function>(method.name, method.arity, method.code, instance));
+}
+
+struct Class : Object {
+   std::string name;
+   std::unordered_map<std::string, std::shared_ptr<Function>> methods; // * Inherited ones included
+   std::shared_ptr<Function> initializer;
+   explicit Class(std::string name) : name(std::move(name)) {}
+   std::string to_string() const override { return name; }
+
+   int arity() const { return initializer ? initializer->arity : 0; }
+   void add_method(const std::string& method_name, const Value& method)
+   {
+      std::shared_ptr<Function> function = std::static_pointer_cast<Function>(method.object);
+      if (method_name == "init") { initializer = function; }
+      methods[method_name] = function;
+   }
+   Function* find_method(const std::string& method_name) const
+   {
+      auto elem = methods.find(method_name);
+      return elem == methods.end() ? nullptr : elem->second.get();
+   }
+};
+
+inline std::shared_ptr<Class> make_class(std::string name, const Value& superclass)
+{
+   std::shared_ptr<Class> lox_class = std::make_shared<Class>(std::move(name));
+   if (superclass.tag == Tag::CLASS)
+   {
+      lox_class->methods = superclass.as<Class>()->methods;
+      lox_class->initializer = superclass.as<Class>()->initializer;
+   }
+   return lox_class;
+}
+
+struct Instance : Object {
+   std::shared_ptr<Class> lox_class;
+   std::unordered_map<std::string, Value> fields;
+   explicit Instance(std::shared_ptr<Class> lox_class) : lox_class(std::move(lox_class)) {}
+   std::string to_string() const override { return lox_class->name + " instance"; }
+};
+
+inline bool truthy(const Value& value)
+{
+   if (value.tag == Tag::NIL) { return false; }
+   if (value.tag == Tag::BOOL) { return value.boolean; }
+   return true;
+}
+
+inline bool equals(const Value& a, const Value& b)
+{
+   if (a.tag != b.tag) { return false; }
+   switch (a.tag)
+   {
+      case Tag::NIL:    return true;
+      case Tag::BOOL:   return a.boolean == b.boolean;
+      case Tag::NUMBER: return a.number == b.number;
+      case Tag::STRING: return a.as<String>()->value == b.as<String>()->value;
+      default:          return a.object == b.object;
+   }
+}
+
+inline std::string stringify(const Value& value)
+{
+   switch (value.tag)
+   {
+      case Tag::NIL:  return "nil";
+      case Tag::BOOL: return value.boolean ? "true" : "false";
+      case Tag::NUMBER: {
+         std::string text = std::to_string(value.number);
+         if (text[text.length() - 2] == '.' && text[text.length() - 1] == '0') {
+            text = text.substr(0, text.length() - 2);
+         }
+         return text;
+      }
+      default: return value.object->to_string();
+   }
+}
+
+inline void print(const Value& value) { std::cout << stringify(value) << "\n"; }
+
+// * Built right operand first, the order the interpreter evaluates them in
+struct Operands {
+   Value right;
+   Value left;
+};
+
+inline void check_numbers(const Operands& operands, int line)
+{
+   if (operands.left.tag != Tag::NUMBER || operands.right.tag != Tag::NUMBER) {
+      throw RuntimeError{line, "Operand must be a number."};
+   }
+}
+
+inline Value add(const Operands& operands, int line)
+{
+   if (operands.left.tag == Tag::NUMBER && operands.right.tag == Tag::NUMBER) {
+      return num(operands.left.number + operands.right.number);
+   }
+   if (operands.left.tag == Tag::STRING && operands.right.tag == Tag::STRING) {
+      return str(operands.left.as<String>()->value + operands.right.as<String>()->value);
+   }
+   throw RuntimeError{line, "Operands must be two numbers or two strings."};
+}
+
+inline Value subtract(const Operands& o, int line)      { check_numbers(o, line); return num(o.left.number - o.right.number); }
+inline Value multiply(const Operands& o, int line)      { check_numbers(o, line); return num(o.left.number * o.right.number); }
+inline Value divide(const Operands& o, int line)        { check_numbers(o, line); return num(o.left.number / o.right.number); }
+inline Value greater(const Operands& o, int line)       { check_numbers(o, line); return Value(o.left.number >  o.right.number); }
+inline Value greater_equal(const Operands& o, int line) { check_numbers(o, line); return Value(o.left.number >= o.right.number); }
+inline Value less(const Operands& o, int line)          { check_numbers(o, line); return Value(o.left.number <  o.right.number); }
+inline Value less_equal(const Operands& o, int line)    { check_numbers(o, line); return Value(o.left.number <= o.right.number); }
+inline Value equal(const Operands& o)                   { return Value(equals(o.left, o.right)); }
+inline Value not_equal(const Operands& o)               { return Value(!equals(o.left, o.right)); }
+
+inline Value negate(const Value& value, int line)
+{
+   if (value.tag != Tag::NUMBER) {
+      throw RuntimeError{line, "Operand must be a number."};
+   }
+   return num(-value.number);
+}
+
+inline Value logical_not(const Value& value) { return Value(!truthy(value)); }
+
+template <typename Right>
+Value logical_or(Value left, Right right) { return truthy(left) ? left : right(); }
+
+template <typename Right>
+Value logical_and(Value left, Right right) { return !truthy(left) ? left : right(); }
+
+struct Global {
+   const char* name;
+   Value value;
+   bool defined = false;
+
+   explicit Global(const char* name) : name(name) {}
+
+   const Value& get(int line) const
+   {
+      if (!defined) { throw RuntimeError{line, std::string("Undefined variable '") + name + "'."}; }
+      return value;
+   }
+   void define(Value a_value) { value = std::move(a_value); defined = true; }
+   Value assign(Value a_value, int line)
+   {
+      if (!defined) { throw RuntimeError{line, std::string("Undefined variable '") + name + "'."}; }
+      value = a_value;
+      return a_value;
+   }
+};
+
+// * The callee is evaluated before the arguments, like the interpreter does
+struct Invocation {
+   Value callee;
+   std::vector<Value> arguments;
+};
+
+inline void check_arity(int arity, std::size_t count, int line)
+{
+   if (static_cast<int>(count) != arity) {
+      throw RuntimeError{line, "Expected " + std::to_string(arity) + " arguments but got " + std::to_string(count) + "."};
+   }
+}
+
+inline Value call(Invocation invocation, int line)
+{
+   switch (invocation.callee.tag)
+   {
+      case Tag::FUNCTION: {
+         Function* function = invocation.callee.as<Function>();
+         check_arity(function->arity, invocation.arguments.size(), line);
+         return (*function->code)(function->receiver, invocation.arguments);
+      }
+      case Tag::CLASS: {
+         std::shared_ptr<Class> lox_class = std::static_pointer_cast<Class>(invocation.callee.object);
+         check_arity(lox_class->arity(), invocation.arguments.size(), line);
+         Value instance(Tag::INSTANCE, std::make_shared<Instance>(lox_class));
+         if (lox_class->initializer) {
+            (*lox_class->initializer->code)(instance, invocation.arguments);
+         }
+         return instance;
+      }
+      case Tag::NATIVE: {
+         Native* native = invocation.callee.as<Native>();
+         check_arity(native->arity, invocation.arguments.size(), line);
+         return native->run();
+      }
+      default:
+         throw RuntimeError{line, "Can only call functions and classes."};
+   }
+}
+
+inline Value get_property(const Value& object, const char* name, int line)
+{
+   if (object.tag != Tag::INSTANCE) {
+      throw RuntimeError{line, "Only instances have properties."};
+   }
+   Instance* instance = object.as<Instance>();
+   auto field = instance->fields.find(name);
+   if (field != instance->fields.end()) {
+      return field->second;
+   }
+   if (Function* method = instance->lox_class->find_method(name)) {
+      return bind(*method, object);
+   }
+   throw RuntimeError{line, std::string("Undefined property '") + name + "'."};
+}
+
+inline Value check_instance(Value object, int line)
+{
+   if (object.tag != Tag::INSTANCE) {
+      throw RuntimeError{line, "Only instances have fields."};
+   }
+   return object;
+}
+
+// * The object is checked before the value is evaluated, like the interpreter does
+struct Assignment {
+   Value object;
+   Value value;
+};
+
+inline Value set_property(Assignment assignment, const char* name)
+{
+   assignment.object.as<Instance>()->fields[name] = assignment.value;
+   return assignment.value;
+}
+
+inline Value get_super(const Value& superclass, const Value& self, const char* name, int line)
+{
+   Function* method = superclass.as<Class>()->find_method(name);
+   if (method == nullptr) {
+      throw RuntimeError{line, std::string("Undefined property '") + name + "'."};
+   }
+   return bind(*method, self);
+}
+
+inline Value check_superclass(Value superclass, int line)
+{
+   if (superclass.tag != Tag::CLASS) {
+      throw RuntimeError{line, "Superclass must be a class."};
+   }
+   return superclass;
+}
+
+inline Value clock()
+{
+   auto ticks = std::chrono::system_clock::now().time_since_epoch();
+   return num(std::chrono::duration<double>{ticks}.count() / 1000.0);
+}
+
+} // namespace lox
+
+using namespace lox;
+)runtime";
\ No newline at end of file
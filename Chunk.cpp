@@ -0,0 +1,39 @@
+#include "headers/Chunk.h"
+#include "headers/VMObjects.h"
+#include <cstring>
+
+void Chunk::write(std::uint8_t byte, const Token* token)
+{
+   code.push_back(byte);
+   tokens.push_back(token);
+}
+
+int Chunk::add_constant(Value value)
+{
+   if (value.is_number())
+   {
+      std::uint64_t bits;
+      double number = value.as_number();
+      std::memcpy(&bits, &number, sizeof bits);
+      auto [elem, added] = number_constants.try_emplace(bits, constants.size());
+      if (added) {
+         constants.push_back(std::move(value)); }
+      return elem->second;
+   }
+   if (value.is_string())
+   {
+      if (auto elem = string_constants.find(value.as_string()); elem != string_constants.end()) {
+         return elem->second; }
+      constants.push_back(std::move(value));
+      string_constants.emplace(constants.back().as_string(), constants.size() - 1);
+      return constants.size() - 1;
+   }
+   constants.push_back(std::move(value));
+   return constants.size() - 1;
+}
+
+int Chunk::add_cache()
+{
+   caches.emplace_back();
+   return caches.size() - 1;
+}
\ No newline at end of file
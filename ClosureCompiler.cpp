@@ -0,0 +1,434 @@
+#include "headers/ClosureCompiler.h"
+#include "headers/Interpreter.h"
+#include "headers/LoxFunction.h"
+#include "headers/LoxInstance.h"
+#include "headers/RuntimeError.h"
+#include <functional>
+#include <iostream>
+
+ClosureCompiler::ClosureCompiler(Arena& arena)
+   : arena(arena)
+{}
+
+std::vector<StmtExecutor> ClosureCompiler::compile(const std::vector<Stmt*>& statements)
+{
+   std::vector<StmtExecutor> executors;
+   executors.reserve(statements.size());
+   for (Stmt* stmt : statements) {
+      executors.push_back(compile(stmt));
+   }
+   return executors;
+}
+
+ExprExecutor ClosureCompiler::compile(Expr* expr)
+{
+   expr->accept(*this);
+   return std::move(expr_result);
+}
+
+StmtExecutor ClosureCompiler::compile(Stmt* stmt)
+{
+   stmt->accept(*this);
+   return std::move(stmt_result);
+}
+
+// * Operands are evaluated right to left like the tree-walker does, so errors come out in the same order
+template <typename Operation>
+ExprExecutor ClosureCompiler::numeric(Binary* expr, ExprExecutor left, ExprExecutor right, Operation operation)
+{
+   return [&op = expr->op, left = std::move(left), right = std::move(right), operation](Interpreter& i) -> Value {
+      Value right_value = right(i);
+      Value left_value  = left(i);
+      i.assert_number_operands(op, left_value, right_value);
+      return operation(left_value.as_number(), right_value.as_number());
+   };
+}
+
+Value ClosureCompiler::visit_BinaryExpr(Binary* expr)
+{
+   ExprExecutor left  = compile(expr->left);
+   ExprExecutor right = compile(expr->right);
+
+   switch (expr->op.type)
+   {
+      case GREATER:       expr_result = numeric(expr, std::move(left), std::move(right), std::greater<double>());       break;
+      case GREATER_EQUAL: expr_result = numeric(expr, std::move(left), std::move(right), std::greater_equal<double>()); break;
+      case LESS:          expr_result = numeric(expr, std::move(left), std::move(right), std::less<double>());          break;
+      case LESS_EQUAL:    expr_result = numeric(expr, std::move(left), std::move(right), std::less_equal<double>());    break;
+      case MINUS:         expr_result = numeric(expr, std::move(left), std::move(right), std::minus<double>());         break;
+      case SLASH:         expr_result = numeric(expr, std::move(left), std::move(right), std::divides<double>());       break;
+      case STAR:          expr_result = numeric(expr, std::move(left), std::move(right), std::multiplies<double>());    break;
+
+      case BANG_EQUAL:
+         expr_result = [left, right](Interpreter& i) -> Value {
+            Value right_value = right(i);
+            return !left(i).equals(right_value);
+         };
+         break;
+      case EQUAL_EQUAL:
+         expr_result = [left, right](Interpreter& i) -> Value {
+            Value right_value = right(i);
+            return left(i).equals(right_value);
+         };
+         break;
+
+      case PLUS:
+         expr_result = [&op = expr->op, left, right](Interpreter& i) -> Value {
+            Value right_value = right(i);
+            Value left_value  = left(i);
+            if (left_value.is_number() && right_value.is_number()) {
+               return left_value.as_number() + right_value.as_number();
+            }
+            if (left_value.is_string() && right_value.is_string()) {
+               return left_value.as_string() + right_value.as_string();
+            }
+            throw RuntimeError(op, "Operands must be two numbers or two strings.");
+         };
+         break;
+
+      default:
+         expr_result = [](Interpreter&) -> Value { return nullptr; };
+   }
+   return nullptr;
+}
+
+// * A group only decides the order of evaluation, which the tree already encodes
+Value ClosureCompiler::visit_GroupExpr(Group* expr)
+{
+   expr_result = compile(expr->expr_in);
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_LiteralExpr(Literal* expr)
+{
+   expr_result = [value = expr->value](Interpreter&) -> Value { return value; };
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_UnaryExpr(Unary* expr)
+{
+   ExprExecutor right = compile(expr->right);
+
+   switch (expr->op.type)
+   {
+      case MINUS:
+         expr_result = [&op = expr->op, right](Interpreter& i) -> Value {
+            Value value = right(i);
+            i.assert_number_operand(op, value);
+            return -value.as_number();
+         };
+         break;
+      case BANG:
+         expr_result = [right](Interpreter& i) -> Value { return !right(i).is_truthy(); };
+         break;
+      default:
+         expr_result = [](Interpreter&) -> Value { return nullptr; };
+   }
+   return nullptr;
+}
+
+// * Locals keep the depth and slot the Resolver found, globals still go through the slot cached on the node
+ExprExecutor ClosureCompiler::variable(const Token& name, Resolution& resolution)
+{
+   if (resolution.is_local())
+   {
+      return [depth = resolution.depth, slot = resolution.slot](Interpreter& i) -> Value {
+         return i.environment->get_at(depth, slot);
+      };
+   }
+   return [&name, &resolution](Interpreter& i) -> Value {
+      return i.global_environment->get_at(0, i.global_slot(name, resolution));
+   };
+}
+
+Value ClosureCompiler::visit_VariableExpr(Variable* expr)
+{
+   expr_result = variable(expr->name, expr->resolution);
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_ThisExpr(This* expr)
+{
+   expr_result = variable(expr->keyword, expr->resolution);
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_AssignExpr(Assign* expr)
+{
+   ExprExecutor value = compile(expr->value);
+
+   if (expr->resolution.is_local())
+   {
+      expr_result = [depth = expr->resolution.depth, slot = expr->resolution.slot, value](Interpreter& i) -> Value {
+         Value result = value(i);
+         i.environment->assign_at(depth, slot, result);
+         return result;
+      };
+   }
+   else {
+      expr_result = [&name = expr->name, &resolution = expr->resolution, value](Interpreter& i) -> Value {
+         Value result = value(i);
+         i.global_environment->assign_at(0, i.global_slot(name, resolution), result);
+         return result;
+      };
+   }
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_LogicalExpr(Logical* expr)
+{
+   ExprExecutor left  = compile(expr->left);
+   ExprExecutor right = compile(expr->right);
+
+   if (expr->op.type == TokenType::OR)
+   {
+      expr_result = [left, right](Interpreter& i) -> Value {
+         Value left_value = left(i);
+         if (left_value.is_truthy()) { return left_value; }
+         return right(i);
+      };
+   }
+   else
+   {
+      expr_result = [left, right](Interpreter& i) -> Value {
+         Value left_value = left(i);
+         if (!left_value.is_truthy()) { return left_value; }
+         return right(i);
+      };
+   }
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_CallExpr(Call* expr)
+{
+   std::vector<ExprExecutor> arguments;
+   arguments.reserve(expr->arguements.size());
+   for (Expr* argument : expr->arguements) {
+      arguments.push_back(compile(argument));
+   }
+
+   // * Lox functions get their arguments straight in their frame, everything else gets them in a vector
+   auto call = [&paren = expr->paren, arguments](Interpreter& i, const Value& callee) -> Value {
+      if (callee.is_function())
+      {
+         LoxFunction* function = callee.as<LoxFunction>();
+         Ref<Environment> frame = function->new_frame(i);
+         for (const ExprExecutor& argument : arguments) {
+            frame->define(argument(i));
+         }
+         return i.call_frame(function, std::move(frame), arguments.size(), paren);
+      }
+
+      std::vector<Value> values;
+      values.reserve(arguments.size());
+      for (const ExprExecutor& argument : arguments) {
+         values.push_back(argument(i));
+      }
+      return i.call_callable(callee, std::move(values), paren);
+   };
+
+   if (expr->property != nullptr)
+   {
+      // * instance.method() runs the method with the instance as "this", no bound method is created
+      Get* property = expr->property;
+      ExprExecutor object = compile(property->object);
+      expr_result = [property, &paren = expr->paren, object, arguments, call](Interpreter& i) -> Value {
+         Value instance = object(i);
+         if (instance.is_instance())
+         {
+            LoxFunction* method = instance.as<LoxInstance>()->find_method(property->name.lexeme, property->cache);
+            if (method != nullptr)
+            {
+               Ref<Environment> frame = method->new_frame(i, instance);
+               for (const ExprExecutor& argument : arguments) {
+                  frame->define(argument(i));
+               }
+               return i.call_frame(method, std::move(frame), arguments.size(), paren);
+            }
+         }
+         return call(i, i.get_property(instance, property->name, property->cache));
+      };
+   }
+   else if (Super* super = expr->super_property)
+   {
+      // * So does super.method()
+      expr_result = [super, &paren = expr->paren, arguments](Interpreter& i) -> Value {
+         int distance = super->resolution.depth;
+         Value instance = i.environment->get_at(distance-1, 0);
+         LoxFunction* method = i.find_super_method(super, i.environment->get_at(distance, 0));
+         Ref<Environment> frame = method->new_frame(i, instance);
+         for (const ExprExecutor& argument : arguments) {
+            frame->define(argument(i));
+         }
+         return i.call_frame(method, std::move(frame), arguments.size(), paren);
+      };
+   }
+   else
+   {
+      ExprExecutor callee = compile(expr->calle);
+      expr_result = [callee, call](Interpreter& i) -> Value {
+         return call(i, callee(i));
+      };
+   }
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_GetExpr(Get* expr)
+{
+   ExprExecutor object = compile(expr->object);
+   expr_result = [expr, object](Interpreter& i) -> Value {
+      return i.get_property(object(i), expr->name, expr->cache);
+   };
+   return nullptr;
+}
+
+Value ClosureCompiler::visit_SetExpr(Set* expr)
+{
+   ExprExecutor object = compile(expr->object);
+   ExprExecutor value  = compile(expr->value);
+   expr_result = [expr, object, value](Interpreter& i) -> Value {
+      Value instance = object(i);
+      if (!instance.is_instance()) {
+         throw RuntimeError(expr->name, "Only instances have fields.");
+      }
+
+      Value result = value(i);
+      instance.as<LoxInstance>()->set(expr->name, result, expr->cache);
+      return result;
+   };
+   return nullptr;
+}
+
+// * Rare enough that the interpreter's own visit does the work
+Value ClosureCompiler::visit_SuperExpr(Super* expr)
+{
+   expr_result = [expr](Interpreter& i) -> Value { return i.visit_SuperExpr(expr); };
+   return nullptr;
+}
+
+Completion ClosureCompiler::visit_ExpressionStmt(Expression* stmt)
+{
+   stmt_result = [expression = compile(stmt->expression)](Interpreter& i) -> Completion {
+      expression(i);
+      return {};
+   };
+   return {};
+}
+
+Completion ClosureCompiler::visit_PrintStmt(Print* stmt)
+{
+   stmt_result = [expression = compile(stmt->expression)](Interpreter& i) -> Completion {
+      Value value = expression(i);
+      i.out << value.to_string() << "\n";
+      return {};
+   };
+   return {};
+}
+
+Completion ClosureCompiler::visit_VarStmt(Var* stmt)
+{
+   ExprExecutor initializer;
+   if (stmt->initializer != nullptr) {
+      initializer = compile(stmt->initializer);
+   }
+
+   stmt_result = [&name = stmt->name, initializer](Interpreter& i) -> Completion {
+      Value value = nullptr;
+      if (initializer) {
+         value = initializer(i);
+      }
+      i.define_variable(name, value);
+      return {};
+   };
+   return {};
+}
+
+Completion ClosureCompiler::visit_BlockStmt(Block* stmt)
+{
+   stmt_result = [statements = compile(stmt->statements)](Interpreter& i) -> Completion {
+      Ref<Environment> block_environment = i.acquire_environment(i.environment);
+      Completion completion = i.execute_block(statements, block_environment);
+      i.release_environment(std::move(block_environment));
+      return completion;
+   };
+   return {};
+}
+
+Completion ClosureCompiler::visit_IfStmt(If* stmt)
+{
+   ExprExecutor condition = compile(stmt->condition);
+   StmtExecutor then_branch = compile(stmt->then_branch);
+   StmtExecutor else_branch;
+   if (stmt->else_branch != nullptr) {
+      else_branch = compile(stmt->else_branch);
+   }
+
+   stmt_result = [condition, then_branch, else_branch](Interpreter& i) -> Completion {
+      if (condition(i).is_truthy()) {
+         return then_branch(i);
+      }
+      else if (else_branch) {
+         return else_branch(i);
+      }
+      return {};
+   };
+   return {};
+}
+
+Completion ClosureCompiler::visit_WhileStmt(While* stmt)
+{
+   ExprExecutor condition = compile(stmt->condition);
+   StmtExecutor body = compile(stmt->body);
+
+   stmt_result = [condition, body](Interpreter& i) -> Completion {
+      while (condition(i).is_truthy())
+      {
+         i.count_back_edge();
+         Completion completion = body(i);
+         if (completion.type == Completion::RETURN) { return completion; }
+      }
+      return {};
+   };
+   return {};
+}
+
+Completion ClosureCompiler::visit_ReturnStmt(Return* stmt)
+{
+   ExprExecutor value;
+   if (stmt->value != nullptr) {
+      value = compile(stmt->value);
+   }
+
+   stmt_result = [value](Interpreter& i) -> Completion {
+      Value result = nullptr;
+      if (value) {
+         result = value(i);
+      }
+      return Completion{Completion::RETURN, result};
+   };
+   return {};
+}
+
+void ClosureCompiler::compile_body(Function* function)
+{
+   FunctionBody* body = arena.make<FunctionBody>();
+   body->statements = compile(function->body);
+   function->compiled_body = body;
+}
+
+// * The body is compiled now, declaring the function is left to the interpreter, LoxFunction finds the body on its declaration
+Completion ClosureCompiler::visit_FunctionStmt(Function* stmt)
+{
+   compile_body(stmt);
+   stmt_result = [stmt](Interpreter& i) -> Completion { return i.visit_FunctionStmt(stmt); };
+   return {};
+}
+
+Completion ClosureCompiler::visit_ClassStmt(Class* stmt)
+{
+   for (Function* method : stmt->methods) {
+      compile_body(method);
+   }
+   stmt_result = [stmt](Interpreter& i) -> Completion { return i.visit_ClassStmt(stmt); };
+   return {};
+}
\ No newline at end of file
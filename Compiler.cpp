@@ -0,0 +1,589 @@
+#include "headers/Compiler.h"
+#include "headers/VM.h"
+#include <cstdint>
+#include <memory>
+
+Compiler::Compiler(VM& vm, Program& program, ErrorReporter& errors)
+   : vm(vm), program(program), errors(errors)
+{}
+
+VMFunction* Compiler::compile()
+{
+   program.functions.push_back(std::make_unique<VMFunction>());
+   VMFunction* script = program.functions.back().get();
+   script->name = "script";
+
+   functions.push_back(FunctionState{script, FunctionType::NONE, 1}); // * Slot 0 holds the closure of the script
+   compile(program.statements);
+   emit(OpCode::NIL);
+   emit(OpCode::RETURN);
+   functions.pop_back();
+
+   return script;
+}
+
+void Compiler::compile(Stmt* stmt)
+{
+   stmt->accept(*this);
+}
+
+void Compiler::compile(Expr* expr)
+{
+   expr->accept(*this);
+}
+
+void Compiler::compile(const std::vector<Stmt*>& statements)
+{
+   for (Stmt* stmt : statements) {
+      compile(stmt);
+   }
+}
+
+// * Compiles the function into a VMFunction of its own, the returned index is where the enclosing chunk keeps it
+int Compiler::compile_function(Function* declaration, FunctionType type)
+{
+   program.functions.push_back(std::make_unique<VMFunction>());
+   VMFunction* function = program.functions.back().get();
+   function->name = declaration->name.lexeme;
+   function->arity = declaration->params.size();
+
+   functions.push_back(FunctionState{function, type, 0});
+   begin_scope();
+   if (type == FunctionType::METHOD or type == FunctionType::INITIALIZER) {
+      add_local(declaration->name); // * "this" is slot 0, where the receiver sits
+   }
+   else {
+      functions.back().local_count = 1; // * Slot 0 holds the closure being called
+   }
+   for (const Token* param : declaration->params) {
+      add_local(*param);
+   }
+   compile(declaration->body);
+   emit_return(&declaration->name);
+
+   scopes.pop_back(); // * Returning discards the whole frame, so the locals need no POPs
+   functions.pop_back();
+
+   chunk().functions.push_back(function);
+   return chunk().functions.size() - 1;
+}
+
+Chunk& Compiler::chunk()
+{
+   return functions.back().function->chunk;
+}
+
+Value Compiler::visit_BinaryExpr(Binary* expr)
+{
+   compile(expr->right);
+   compile(expr->left);
+
+   switch (expr->op.type)
+   {
+      case GREATER:       emit(OpCode::GREATER, &expr->op);       break;
+      case GREATER_EQUAL: emit(OpCode::GREATER_EQUAL, &expr->op); break;
+      case LESS:          emit(OpCode::LESS, &expr->op);          break;
+      case LESS_EQUAL:    emit(OpCode::LESS_EQUAL, &expr->op);    break;
+      case BANG_EQUAL:    emit(OpCode::NOT_EQUAL, &expr->op);     break;
+      case EQUAL_EQUAL:   emit(OpCode::EQUAL, &expr->op);         break;
+      case MINUS:         emit(OpCode::SUBTRACT, &expr->op);      break;
+      case SLASH:         emit(OpCode::DIVIDE, &expr->op);        break;
+      case STAR:          emit(OpCode::MULTIPLY, &expr->op);      break;
+      case PLUS:          emit(OpCode::ADD, &expr->op);           break;
+      default:            break;
+   }
+   return nullptr;
+}
+
+Value Compiler::visit_GroupExpr(Group* expr)
+{
+   compile(expr->expr_in);
+   return nullptr;
+}
+
+Value Compiler::visit_LiteralExpr(Literal* expr)
+{
+   if (expr->value.is_nil()) {
+      emit(OpCode::NIL);
+   }
+   else if (expr->value.is_bool()) {
+      emit(expr->value.as_bool() ? OpCode::LOX_TRUE : OpCode::LOX_FALSE);
+   }
+   else {
+      emit(OpCode::CONSTANT, &expr->token);
+      emit_index(make_constant(expr->value, expr->token), &expr->token);
+   }
+   return nullptr;
+}
+
+Value Compiler::visit_UnaryExpr(Unary* expr)
+{
+   compile(expr->right);
+
+   switch (expr->op.type)
+   {
+      case MINUS: emit(OpCode::NEGATE, &expr->op); break;
+      case BANG:  emit(OpCode::NOT, &expr->op);    break;
+      default:    break;
+   }
+   return nullptr;
+}
+
+Value Compiler::visit_VariableExpr(Variable* expr)
+{
+   load_variable(expr->name, expr->resolution);
+   return nullptr;
+}
+
+Value Compiler::visit_AssignExpr(Assign* expr)
+{
+   compile(expr->value);
+   store_variable(expr->name, expr->resolution);
+   return nullptr;
+}
+
+Value Compiler::visit_LogicalExpr(Logical* expr)
+{
+   compile(expr->left);
+   OpCode op = expr->op.type == TokenType::OR ? OpCode::JUMP_IF_TRUE_OR_POP : OpCode::JUMP_IF_FALSE_OR_POP;
+   int end_jump = emit_jump(op, expr->op);
+   compile(expr->right);
+   patch_jump(end_jump, expr->op);
+   return nullptr;
+}
+
+// * instance.method() and super.method() find the method before the arguments are evaluated and call it without binding it
+Value Compiler::visit_CallExpr(Call* expr)
+{
+   OpCode call = OpCode::CALL_METHOD;
+   if (expr->property != nullptr)
+   {
+      compile(expr->property->object);
+      emit(OpCode::GET_METHOD, &expr->property->name);
+      emit_index(make_cache(expr->property->name), &expr->property->name);
+   }
+   else if (Super* super = dynamic_cast<Super*>(expr->calle))
+   {
+      load_variable(super->keyword, Resolution{super->resolution.depth - 1, 0}); // * "this"
+      load_variable(super->keyword, super->resolution);
+      emit(OpCode::SUPER_METHOD, &super->method);
+      emit_index(make_cache(super->method), &super->method);
+   }
+   else {
+      compile(expr->calle);
+      call = OpCode::CALL;
+   }
+
+   for (Expr* argument : expr->arguements) {
+      compile(argument);
+   }
+   emit(call, &expr->paren);
+   emit_byte(expr->arguements.size(), &expr->paren);
+   return nullptr;
+}
+
+Value Compiler::visit_GetExpr(Get* expr)
+{
+   compile(expr->object);
+   emit(OpCode::GET_PROPERTY, &expr->name);
+   emit_index(make_cache(expr->name), &expr->name);
+   return nullptr;
+}
+
+Value Compiler::visit_SetExpr(Set* expr)
+{
+   compile(expr->object);
+
+   // * The Interpreter checks the object before it evaluates the value, "this" and literals need no early check
+   if (dynamic_cast<This*>(expr->object) == nullptr and dynamic_cast<Literal*>(expr->value) == nullptr) {
+      emit(OpCode::CHECK_INSTANCE, &expr->name);
+   }
+
+   compile(expr->value);
+   emit(OpCode::SET_PROPERTY, &expr->name);
+   emit_index(make_cache(expr->name), &expr->name);
+   return nullptr;
+}
+
+Value Compiler::visit_ThisExpr(This* expr)
+{
+   load_variable(expr->keyword, expr->resolution);
+   return nullptr;
+}
+
+Value Compiler::visit_SuperExpr(Super* expr)
+{
+   load_variable(expr->keyword, Resolution{expr->resolution.depth - 1, 0}); // * "this"
+   load_variable(expr->keyword, expr->resolution);
+   emit(OpCode::GET_SUPER, &expr->method);
+   emit_index(make_cache(expr->method), &expr->method);
+   return nullptr;
+}
+
+Completion Compiler::visit_ExpressionStmt(Expression* stmt)
+{
+   compile(stmt->expression);
+   emit(OpCode::POP);
+   return {};
+}
+
+Completion Compiler::visit_PrintStmt(Print* stmt)
+{
+   compile(stmt->expression);
+   emit(OpCode::PRINT);
+   return {};
+}
+
+Completion Compiler::visit_VarStmt(Var* stmt)
+{
+   if (stmt->initializer != nullptr) {
+      compile(stmt->initializer);
+   }
+   else {
+      emit(OpCode::NIL);
+   }
+   define_variable(stmt->name);
+   return {};
+}
+
+Completion Compiler::visit_BlockStmt(Block* stmt)
+{
+   begin_scope();
+   compile(stmt->statements);
+   end_scope();
+   return {};
+}
+
+Completion Compiler::visit_IfStmt(If* stmt)
+{
+   compile(stmt->condition);
+   int else_jump = emit_jump(OpCode::JUMP_IF_FALSE, stmt->keyword);
+   compile(stmt->then_branch);
+
+   if (stmt->else_branch != nullptr)
+   {
+      int end_jump = emit_jump(OpCode::JUMP, stmt->keyword);
+      patch_jump(else_jump, stmt->keyword);
+      compile(stmt->else_branch);
+      patch_jump(end_jump, stmt->keyword);
+   }
+   else {
+      patch_jump(else_jump, stmt->keyword);
+   }
+   return {};
+}
+
+Completion Compiler::visit_WhileStmt(While* stmt)
+{
+   int loop_start = chunk().code.size();
+   compile(stmt->condition);
+   int exit_jump = emit_jump(OpCode::JUMP_IF_FALSE, stmt->keyword);
+   compile(stmt->body);
+   emit_loop(loop_start, stmt->keyword);
+   patch_jump(exit_jump, stmt->keyword);
+   return {};
+}
+
+// * A local function gets its slot before the body is compiled, so the body can refer to the function through an upvalue
+Completion Compiler::visit_FunctionStmt(Function* stmt)
+{
+   if (!scopes.empty()) {
+      add_local(stmt->name);
+   }
+
+   int function = compile_function(stmt, FunctionType::FUNCTION);
+   emit(OpCode::CLOSURE, &stmt->name);
+   emit_index(make_function(function, stmt->name), &stmt->name);
+
+   if (scopes.empty()) {
+      define_variable(stmt->name);
+   }
+   return {};
+}
+
+Completion Compiler::visit_ReturnStmt(Return* stmt)
+{
+   if (stmt->value != nullptr) {
+      compile(stmt->value);
+      emit(OpCode::RETURN, &stmt->keyword);
+   }
+   else {
+      emit_return(&stmt->keyword);
+   }
+   return {};
+}
+
+/*
+   Same order as the Interpreter: the superclass is checked before the class variable is defined.
+   The superclass is loaded a second time into the scope holding "super", the Resolver gave that scope to the methods
+*/
+Completion Compiler::visit_ClassStmt(Class* stmt)
+{
+   bool has_superclass = stmt->superclass != nullptr;
+   if (has_superclass) {
+      compile(stmt->superclass);
+   }
+
+   const Token* token = has_superclass ? &stmt->superclass->name : &stmt->name;
+   emit(OpCode::CLASS, token);
+   emit_index(make_constant(std::string(stmt->name.lexeme), *token), token);
+   emit_byte(has_superclass, token);
+
+   int class_slot = -1;
+   if (scopes.empty()) {
+      define_variable(stmt->name);
+   }
+   else {
+      class_slot = add_local(stmt->name);
+   }
+
+   if (has_superclass) {
+      compile(stmt->superclass); // * Resolved outside the scope of "super", so it is loaded before that scope begins
+      begin_scope();
+      add_local(stmt->superclass->name);
+   }
+
+   if (class_slot < 0) {
+      emit(OpCode::GET_GLOBAL, &stmt->name);
+      emit_index(global_slot(stmt->name), &stmt->name);
+   }
+   else {
+      emit(OpCode::GET_LOCAL, &stmt->name);
+      emit_byte(class_slot, &stmt->name);
+   }
+
+   for (Function* method : stmt->methods)
+   {
+      FunctionType type = method->name.lexeme == "init" ? FunctionType::INITIALIZER : FunctionType::METHOD;
+      int function = compile_function(method, type);
+      emit(OpCode::CLOSURE, &method->name);
+      emit_index(make_function(function, method->name), &method->name);
+      emit(OpCode::METHOD, &method->name);
+   }
+   emit(OpCode::POP);
+
+   if (has_superclass) {
+      end_scope();
+   }
+   return {};
+}
+
+void Compiler::emit(OpCode op, const Token* token)
+{
+   chunk().write(static_cast<std::uint8_t>(op), token);
+}
+
+void Compiler::emit_byte(int byte, const Token* token)
+{
+   chunk().write(byte, token);
+}
+
+void Compiler::emit_short(int value, const Token* token)
+{
+   emit_byte((value >> 8) & 0xff, token);
+   emit_byte(value & 0xff, token);
+}
+
+// * Initializers always return "this"
+void Compiler::emit_return(const Token* token)
+{
+   if (functions.back().type == FunctionType::INITIALIZER) {
+      emit(OpCode::GET_LOCAL, token);
+      emit_byte(0, token);
+   }
+   else {
+      emit(OpCode::NIL, token);
+   }
+   emit(OpCode::RETURN, token);
+}
+
+void Compiler::emit_index(int index, const Token* token)
+{
+   emit_byte((index >> 16) & 0xff, token);
+   emit_short(index & 0xffff, token);
+}
+
+// * Returns where the offset goes, patch_jump fills it in once the target is known
+int Compiler::emit_jump(OpCode op, const Token& token)
+{
+   emit(op, &token);
+   emit_short(0xffff, &token);
+   return chunk().code.size() - 2;
+}
+
+void Compiler::patch_jump(int offset, const Token& token)
+{
+   std::vector<std::uint8_t>& code = chunk().code;
+   int jump = code.size() - offset - 2;
+   if (jump > UINT16_MAX) {
+      limit_error(functions.back(), JUMP, token, "Too much code to jump over.");
+   }
+
+   code[offset] = (jump >> 8) & 0xff;
+   code[offset + 1] = jump & 0xff;
+}
+
+void Compiler::emit_loop(int loop_start, const Token& token)
+{
+   emit(OpCode::LOOP, &token);
+   int offset = chunk().code.size() - loop_start + 2;
+   if (offset > UINT16_MAX) {
+      limit_error(functions.back(), LOOP, token, "Loop body too large.");
+   }
+   emit_short(offset, &token);
+}
+
+int Compiler::make_constant(Value value, const Token& token)
+{
+   int constant = chunk().add_constant(std::move(value));
+   if (constant > MAX_INDEX) {
+      limit_error(functions.back(), CONSTANTS, token, "Too many constants in one chunk.");
+   }
+   return constant;
+}
+
+int Compiler::make_cache(const Token& token)
+{
+   int cache = chunk().add_cache();
+   if (cache > MAX_INDEX) {
+      limit_error(functions.back(), CACHES, token, "Too many property accesses in one chunk.");
+   }
+   return cache;
+}
+
+// * function is where compile_function put it in the chunk's functions
+int Compiler::make_function(int function, const Token& token)
+{
+   if (function > MAX_INDEX) {
+      limit_error(functions.back(), FUNCTIONS, token, "Too many functions in one chunk.");
+   }
+   return function;
+}
+
+int Compiler::global_slot(const Token& name)
+{
+   int slot = vm.global_slot(std::string(name.lexeme));
+   if (slot > MAX_INDEX) {
+      limit_error(functions.back(), GLOBALS, name, "Too many global variables.");
+   }
+   return slot;
+}
+
+// * Past a limit every further use would fail the same way, only the first one is reported
+void Compiler::limit_error(FunctionState& state, Limit limit, const Token& token, const std::string& message)
+{
+   if ((state.limits_reported & limit) == 0) {
+      state.limits_reported |= limit;
+      errors.error(token, message);
+   }
+}
+
+void Compiler::begin_scope()
+{
+   scopes.emplace_back();
+}
+
+// * Locals an inner function captured move into their upvalue, the others are just popped
+void Compiler::end_scope()
+{
+   const std::vector<Local>& scope = scopes.back();
+   for (auto local = scope.rbegin(); local != scope.rend(); ++local) {
+      emit(local->captured ? OpCode::CLOSE_UPVALUE : OpCode::POP);
+   }
+   functions.back().local_count -= scope.size();
+   scopes.pop_back();
+}
+
+// * The value of the new local is whatever sits on top of the stack, that slot becomes the local's
+int Compiler::add_local(const Token& name)
+{
+   FunctionState& state = functions.back();
+   if (state.local_count > UINT8_MAX) {
+      limit_error(state, LOCALS, name, "Too many local variables in function.");
+   }
+
+   scopes.back().push_back(Local{static_cast<int>(functions.size()) - 1, state.local_count});
+   return state.local_count++;
+}
+
+void Compiler::define_variable(const Token& name)
+{
+   if (scopes.empty()) {
+      emit(OpCode::DEFINE_GLOBAL, &name);
+      emit_index(global_slot(name), &name);
+   }
+   else {
+      add_local(name);
+   }
+}
+
+void Compiler::load_variable(const Token& name, const Resolution& resolution)
+{
+   if (!resolution.is_local()) {
+      emit(OpCode::GET_GLOBAL, &name);
+      emit_index(global_slot(name), &name);
+      return;
+   }
+
+   Local& local = find_local(resolution);
+   int current = functions.size() - 1;
+   if (local.function == current) {
+      emit(OpCode::GET_LOCAL, &name);
+      emit_byte(local.slot, &name);
+   }
+   else {
+      emit(OpCode::GET_UPVALUE, &name);
+      emit_index(resolve_upvalue(current, local, name), &name);
+   }
+}
+
+void Compiler::store_variable(const Token& name, const Resolution& resolution)
+{
+   if (!resolution.is_local()) {
+      emit(OpCode::SET_GLOBAL, &name);
+      emit_index(global_slot(name), &name);
+      return;
+   }
+
+   Local& local = find_local(resolution);
+   int current = functions.size() - 1;
+   if (local.function == current) {
+      emit(OpCode::SET_LOCAL, &name);
+      emit_byte(local.slot, &name);
+   }
+   else {
+      emit(OpCode::SET_UPVALUE, &name);
+      emit_index(resolve_upvalue(current, local, name), &name);
+   }
+}
+
+Compiler::Local& Compiler::find_local(const Resolution& resolution)
+{
+   return scopes[scopes.size() - 1 - resolution.depth][resolution.slot];
+}
+
+// * Every function between the one the local belongs to and the one using it gets an upvalue for it
+int Compiler::resolve_upvalue(int function, Local& local, const Token& name)
+{
+   if (local.function == function - 1) {
+      local.captured = true;
+      return add_upvalue(function, true, local.slot, name);
+   }
+   return add_upvalue(function, false, resolve_upvalue(function - 1, local, name), name);
+}
+
+int Compiler::add_upvalue(int function, bool is_local, int index, const Token& name)
+{
+   std::vector<UpvalueSource>& upvalues = functions[function].function->upvalues;
+   for (int i = 0; i < static_cast<int>(upvalues.size()); ++i) {
+      if (upvalues[i].is_local == is_local and upvalues[i].index == index) {
+         return i;
+      }
+   }
+
+   upvalues.push_back(UpvalueSource{is_local, index});
+   if (static_cast<int>(upvalues.size()) - 1 > MAX_INDEX) {
+      limit_error(functions[function], UPVALUES, name, "Too many closure variables in function.");
+   }
+   return upvalues.size() - 1;
+}
\ No newline at end of file
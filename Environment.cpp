@@ -2,65 +2,97 @@
 #include "headers/RuntimeError.h"
 
 Environment::Environment()
-   :enclosing(nullptr)
-{}
+   :enclosing(nullptr), values(SpareVectors<Value>::take())
+{
+   track();
+}
 
-Environment::Environment(std::shared_ptr<Environment> enclosing)
-   :enclosing(enclosing)
-{}
+Environment::Environment(Ref<Environment> enclosing)
+   :enclosing(std::move(enclosing)), values(SpareVectors<Value>::take())
+{
+   track();
+}
 
-void Environment::define(std::string name, std::any value)
+Environment::~Environment()
 {
-   values[name] = value;
+   SpareVectors<Value>::give_back(values);
 }
 
-std::any Environment::get(Token name)
+void Environment::trace(Tracer& tracer)
 {
-   if (values.find(name.lexeme) != values.end())
-   {
-      return values[name.lexeme];
+   tracer.visit(enclosing.get());
+   for (const Value& value : values) {
+      tracer.visit(value);
    }
+}
 
-   //* If the variable isn’t found in this environment, we recursively try the enclosing one.
-   if (enclosing != nullptr) { return enclosing->get(name); }
-   
-   throw RuntimeError(name, "Undefined variable '" + name.lexeme + "'.");
+void Environment::clear_references()
+{
+   enclosing = nullptr;
+   values.clear();
 }
 
-std::any Environment::get_at(int distance, std::string name)
+//* Locals are defined in the same order the Resolver handed out their slots
+int Environment::define(Value value)
 {
-   return ancestor(distance)->values[name];
+   values.push_back(std::move(value));
+   return values.size() - 1;
 }
 
- std::shared_ptr<Environment> Environment::ancestor(int distance)
+int Environment::define(const std::string& name, Value value)
 {
-   std::shared_ptr<Environment> environment = shared_from_this();
-   for (int i = 0; i < distance; ++i) {
-      environment = environment->enclosing;
+   if (names == nullptr) {
+      names = std::make_unique<std::unordered_map<std::string, int>>();
+   }
+   auto elem = names->find(name);
+   if (elem != names->end())
+   {
+      values[elem->second] = std::move(value);
+      return elem->second;
    }
 
-   return environment;
+   int slot = define(std::move(value));
+   (*names)[name] = slot;
+   return slot;
 }
 
-void Environment::assign(Token name, std::any value)
+//* Used for globals only, redefining a global keeps its slot so the slot of a name never changes
+int Environment::slot_of(const Token& name)
 {
-   if (values.find(name.lexeme) != values.end())
+   if (names != nullptr)
    {
-      values[name.lexeme] = value; 
-      return;
+      auto elem = names->find(std::string(name.lexeme));
+      if (elem != names->end()) {
+         return elem->second;
+      }
    }
 
-   if (enclosing != nullptr) 
-   {
-      //* if the variable isn’t in this environment, it checks the outer one, recursively.
-      enclosing->assign(name, value);
-      return;
+   throw RuntimeError(name, "Undefined variable '" + std::string(name.lexeme) + "'.");
+}
+
+Value Environment::get_at(int distance, int slot)
+{
+   return ancestor(distance)->values[slot];
+}
+
+Environment* Environment::ancestor(int distance)
+{
+   Environment* environment = this;
+   for (int i = 0; i < distance; ++i) {
+      environment = environment->enclosing.get();
    }
 
-   throw RuntimeError(name, "Undefined variable '"+ name.lexeme + "'."); 
+   return environment;
+}
+
+//* Empties the environment for reuse, the slots keep their capacity
+void Environment::reset(Ref<Environment> a_enclosing)
+{
+   values.clear();
+   enclosing = std::move(a_enclosing);
 }
 
-void Environment::assign_at(int distance, Token name, std::any value)
+void Environment::assign_at(int distance, int slot, Value value)
 {
-   ancestor(distance)->values[name.lexeme] = value;
+   ancestor(distance)->values[slot] = std::move(value);
 }
\ No newline at end of file
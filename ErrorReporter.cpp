@@ -0,0 +1,35 @@
+#include "headers/ErrorReporter.h"
+
+void ErrorReporter::error(int line, const std::string& message)
+{
+   report(line, "", message);
+}
+
+void ErrorReporter::error(const Token& token, const std::string& message)
+{
+   if (token.type == END_OF_FILE) 
+   {
+      report(token.line, " at end", message);
+   } 
+   else 
+   {
+      report(token.line, " at '" + std::string(token.lexeme) + "'", message);
+   }
+}
+
+void ErrorReporter::runtime_error(const RuntimeError& error)
+{
+   err << error.what() << std::endl << "[line " << error.token.line << "]\n";
+   had_runtime_error = true; 
+}
+
+void ErrorReporter::note(const std::string& message)
+{
+   err << message << std::endl;
+}
+
+void ErrorReporter::report(int line, const std::string& where, const std::string& message)
+{
+   err << "[line " << line << "] Error" << where << ": " << message << "\n";
+   had_error = true;
+}
\ No newline at end of file
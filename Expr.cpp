@@ -7,131 +7,131 @@
 // ** --    Visitor visits a BinaryExpr by calling its accept method and passing itself by reference
 // ** --    the BinaryExpr calls the visit_BinaryExpr method of the visitor and passes a pointer to itself as an argument  
 
-Binary::Binary(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right)
+Binary::Binary(Expr* left, const Token& op, Expr* right)
    : left(left), op(op), right(right)
 { }
 
-std::any Binary::accept(ExprVisitor &visitor) 
+Value Binary::accept(ExprVisitor &visitor) 
 {
-   return visitor.visit_BinaryExpr(shared_from_this());
+   return visitor.visit_BinaryExpr(this);
 }
 // *----------------Group----------------------
-Group::Group(std::shared_ptr<Expr> expr_in) 
+Group::Group(Expr* expr_in) 
    : expr_in(expr_in)
 { }
 
-std::any Group::accept(ExprVisitor &visitor)
+Value Group::accept(ExprVisitor &visitor)
 {
-   return visitor.visit_GroupExpr(shared_from_this());
+   return visitor.visit_GroupExpr(this);
 }
 
 // *----------------Literal----------------------
 
-Literal::Literal(std::any value) 
-   : value(value)
+Literal::Literal(const Token& token, Value value) 
+   : token(token), value(value)
 { }
 
-std::any Literal::accept(ExprVisitor &visitor)
+Value Literal::accept(ExprVisitor &visitor)
 {
-   return visitor.visit_LiteralExpr(shared_from_this());
+   return visitor.visit_LiteralExpr(this);
 }
 
 // *-----------------Unary-----------------------
 
-Unary::Unary(Token op, std::shared_ptr<Expr> right) 
+Unary::Unary(const Token& op, Expr* right) 
    : op(op), right(right)
 { }
 
-std::any Unary::accept(ExprVisitor &visitor)
+Value Unary::accept(ExprVisitor &visitor)
 {
-   return visitor.visit_UnaryExpr(shared_from_this());
+   return visitor.visit_UnaryExpr(this);
 }
 
 // *-----------------Variable-----------------------
 
-Variable::Variable(Token name)
+Variable::Variable(const Token& name)
     : name(name)
   {}
 
-std::any Variable::accept(ExprVisitor& visitor) {
-   return visitor.visit_VariableExpr(shared_from_this());
+Value Variable::accept(ExprVisitor& visitor) {
+   return visitor.visit_VariableExpr(this);
 }
 
 // *-----------------Assign-----------------------
 
-Assign::Assign(Token name, std::shared_ptr<Expr> value)
+Assign::Assign(const Token& name, Expr* value)
    : name(name), value(value)
 { }
 
 
-std::any Assign::accept(ExprVisitor& visitor)
+Value Assign::accept(ExprVisitor& visitor)
 {
-   return visitor.visit_AssignExpr(shared_from_this());
+   return visitor.visit_AssignExpr(this);
 }
 
 // *-----------------Logical-----------------------
 
-Logical::Logical(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right)
+Logical::Logical(Expr* left, const Token& op, Expr* right)
    :left(left), op(op), right(right)
 { }
 
-std::any Logical::accept(ExprVisitor& visitor)
+Value Logical::accept(ExprVisitor& visitor)
 {
-  return visitor.visit_LogicalExpr(shared_from_this());
+  return visitor.visit_LogicalExpr(this);
 }
 
 // *-----------------Call-----------------------
 
-Call::Call(std::shared_ptr<Expr> calle, Token paren, std::vector<std::shared_ptr<Expr>> arguements)
-   :calle(calle), paren(paren), arguements(arguements)
+Call::Call(Expr* calle, const Token& paren, std::vector<Expr*> arguements)
+   :calle(calle), paren(paren), arguements(std::move(arguements)), property(dynamic_cast<Get*>(calle)), super_property(dynamic_cast<Super*>(calle))
 {}
 
-std::any Call::accept(ExprVisitor& visitor)
+Value Call::accept(ExprVisitor& visitor)
 {
-   return visitor.visit_CallExpr(shared_from_this());
+   return visitor.visit_CallExpr(this);
 }
 
 // *-----------------Get-----------------------
 
-Get::Get(std::shared_ptr<Expr> object, Token name)
+Get::Get(Expr* object, const Token& name)
    :object(object), name(name)
 {}
 
 
-std::any Get::accept(ExprVisitor& visitor)
+Value Get::accept(ExprVisitor& visitor)
 {
-   return visitor.visit_GetExpr(shared_from_this());
+   return visitor.visit_GetExpr(this);
 }
 
 // *-----------------Set-----------------------
 
-Set::Set(std::shared_ptr<Expr> object, Token name, std::shared_ptr<Expr> value)
+Set::Set(Expr* object, const Token& name, Expr* value)
    :object(object), name(name), value(value)
 { }
 
-std::any Set::accept(ExprVisitor& visitor)
+Value Set::accept(ExprVisitor& visitor)
 {
-   return visitor.visit_SetExpr(shared_from_this());
+   return visitor.visit_SetExpr(this);
 }
 
 // *-----------------This-----------------------
 
-This::This(Token keyword)
+This::This(const Token& keyword)
    : keyword(keyword)
 { }
 
-std::any This::accept(ExprVisitor& visitor)
+Value This::accept(ExprVisitor& visitor)
 {
-   return visitor.visit_ThisExpr(shared_from_this());
+   return visitor.visit_ThisExpr(this);
 }
 
 // *-----------------Super-----------------------
 
-Super::Super(Token keyword, Token method)
+Super::Super(const Token& keyword, const Token& method)
    : keyword(keyword), method(method)
 { }
 
-std::any Super::accept(ExprVisitor& visitor)
+Value Super::accept(ExprVisitor& visitor)
 {
-   return visitor.visit_SuperExpr(shared_from_this());
+   return visitor.visit_SuperExpr(this);
 }
@@ -0,0 +1,128 @@
+#include "headers/Heap.h"
+#include "headers/Value.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+void Tracer::visit(const Value& value)
+{
+   if (value.is_object()) {
+      visit(value.as<HeapObject>());
+   }
+}
+
+HeapObject::~HeapObject()
+{
+   if (tracked) {
+      previous->next = next;
+      next->previous = previous;
+   }
+}
+
+void HeapObject::track()
+{
+   if (Heap::current != nullptr) {
+      Heap::current->track(this);
+   }
+}
+
+Heap::Heap()
+{
+   objects.previous = &objects;
+   objects.next = &objects;
+}
+
+Heap::~Heap()
+{
+   HeapObject* object = objects.next;
+   while (object != &objects) {
+      HeapObject* next = object->next;
+      object->tracked = false;
+      object->previous = object->next = nullptr;
+      object = next;
+   }
+}
+
+void Heap::track(HeapObject* object)
+{
+   object->tracked = true;
+   object->previous = &objects;
+   object->next = objects.next;
+   objects.next->previous = object;
+   objects.next = object;
+   ++tracked_since_collection;
+}
+
+void Heap::collect()
+{
+   auto begin = std::chrono::steady_clock::now();
+
+   // * Whatever is left of an object's count after the tracked objects' references are taken off comes from outside: a root
+   struct TakeInternalReferences : Tracer {
+      using Tracer::visit;
+      void visit(HeapObject* object) override
+      {
+         if (object != nullptr and object->tracked) { --object->gc_refs; }
+      }
+   };
+   struct Mark : Tracer {
+      using Tracer::visit;
+      std::vector<HeapObject*> pending;
+      void visit(HeapObject* object) override
+      {
+         if (object != nullptr and object->tracked and not object->reachable) {
+            object->reachable = true;
+            pending.push_back(object);
+         }
+      }
+   };
+
+   for (HeapObject* object = objects.next; object != &objects; object = object->next) {
+      object->gc_refs = object->ref_count;
+      object->reachable = false;
+   }
+   TakeInternalReferences take_internal_references;
+   for (HeapObject* object = objects.next; object != &objects; object = object->next) {
+      object->trace(take_internal_references);
+   }
+
+   Mark mark;
+   for (HeapObject* object = objects.next; object != &objects; object = object->next) {
+      if (object->gc_refs > 0) { mark.visit(object); }
+   }
+   while (not mark.pending.empty()) {
+      HeapObject* object = mark.pending.back();
+      mark.pending.pop_back();
+      object->trace(mark);
+   }
+
+   // * The garbage is held on to while it is taken apart, so nothing is freed while its references are still being cleared
+   std::vector<Ref<HeapObject>> garbage;
+   survivors = 0;
+   for (HeapObject* object = objects.next; object != &objects; object = object->next) {
+      if (not object->reachable) { garbage.emplace_back(object); }
+      else { ++survivors; }
+   }
+   for (Ref<HeapObject>& object : garbage) {
+      object->clear_references();
+   }
+   objects_freed += garbage.size();
+   garbage.clear();
+
+   most_survivors = std::max(most_survivors, survivors);
+   collections++;
+   tracked_since_collection = 0;
+   next_collection = std::max(MIN_COLLECTION, survivors);
+   double pause_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+   total_pause_ms += pause_ms;
+   longest_pause_ms = std::max(longest_pause_ms, pause_ms);
+}
+
+void Heap::print_stats(std::ostream& out) const
+{
+   out << "[gc] " << collections << " collections freed " << objects_freed << " objects in cycles, "
+       << total_pause_ms << " ms in total, longest pause " << longest_pause_ms << " ms" << std::endl;
+   out << "[gc] " << survivors << " objects survived the last collection, at most " << most_survivors
+       << ", next collection after " << next_collection - std::min(next_collection, tracked_since_collection)
+       << " more objects are tracked" << std::endl;
+}
\ No newline at end of file
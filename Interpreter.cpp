@@ -1,103 +1,160 @@
 #include "headers/LoxFunction.h"
-#include "headers/Lox.h"
+#include "headers/Interpreter.h"
 #include "headers/LoxClass.h"
 #include "headers/LoxInstance.h"
+#include "headers/Natives.h"
 #include <iostream>
 
-Interpreter::Interpreter()
+Interpreter::Interpreter(std::ostream& out, ErrorReporter& errors, Heap& heap)
+   : jit(*global_environment, errors), out(out), errors(errors), heap(heap)
 {
-   global_environment->define("clock", std::shared_ptr<NativeClock>{});
+   global_environment->define("clock", Ref<NativeFunction>{new NativeClock()});
 
 }
 
-void Interpreter::interpret(std::vector<std::shared_ptr<Stmt>> statements)
+void Interpreter::interpret(std::vector<Stmt*> statements)
 {
    try 
    {
-      for (std::shared_ptr<Stmt> statement : statements) {
+      for (Stmt* statement : statements) {
          execute(statement);
       }
 
    } catch (RuntimeError const& error) {
-      Lox::runtime_error(error);
+      current_function = nullptr;
+      errors.runtime_error(error);
    }
 }
 
-void Interpreter::execute(std::shared_ptr<Stmt> stmt)
+void Interpreter::interpret(const std::vector<StmtExecutor>& statements)
 {
-   stmt->accept(*this);
+   try 
+   {
+      for (const StmtExecutor& statement : statements) {
+         execute(statement);
+      }
+
+   } catch (RuntimeError const& error) {
+      current_function = nullptr;
+      errors.runtime_error(error);
+   }
 }
 
-std::any Interpreter::evaluate(std::shared_ptr<Expr> expr)
+Completion Interpreter::execute(Stmt* stmt)
+{
+   collect_if_due();
+   return stmt->accept(*this);
+}
+
+Completion Interpreter::execute(const StmtExecutor& stmt)
+{
+   collect_if_due();
+   return stmt(*this);
+}
+
+Value Interpreter::evaluate(Expr* expr)
 {
    return expr->accept(*this);
 }
 
-void Interpreter::execute_block(std::vector<std::shared_ptr<Stmt>> statements, std::shared_ptr<Environment> a_environment)
+Completion Interpreter::execute_block(const std::vector<Stmt*>& statements, Ref<Environment> a_environment)
+{
+   return run_block(statements, std::move(a_environment));
+}
+
+Completion Interpreter::execute_block(const std::vector<StmtExecutor>& statements, Ref<Environment> a_environment)
 {
-   std::shared_ptr<Environment> previous = this->environment;
+   return run_block(statements, std::move(a_environment));
+}
+
+// * A return stops the block early and hands its Completion to the caller, runtime errors are the only thing thrown
+template <typename Statement>
+Completion Interpreter::run_block(const std::vector<Statement>& statements, Ref<Environment> a_environment)
+{
+   Ref<Environment> previous = std::move(this->environment);
    try {
-      this->environment = a_environment;
+      this->environment = std::move(a_environment);
 
-      for (std::shared_ptr<Stmt> stmt : statements){
-         execute(stmt);
+      for (const Statement& stmt : statements){
+         Completion completion = execute(stmt);
+         if (completion.type == Completion::RETURN) {
+            this->environment = std::move(previous);
+            return completion;
+         }
       }
    } catch(...) // *-> Catch anything
    {
-      this->environment = previous; //*-> this block always executes and then throw the error again
+      this->environment = std::move(previous); //*-> this block always executes and then throw the error again
       throw;
    }
 
-   this->environment = previous;
+   this->environment = std::move(previous);
+   return {};
 }
 
-void Interpreter::resolve(std::shared_ptr<Expr> expr, int depth)
+Ref<Environment> Interpreter::acquire_environment(Ref<Environment> enclosing)
 {
-   locals[expr] = depth;
+   if (environment_pool.empty()) {
+      return Ref<Environment>{new Environment(std::move(enclosing))};
+   }
+
+   Ref<Environment> recycled = std::move(environment_pool.back());
+   environment_pool.pop_back();
+   recycled->reset(std::move(enclosing));
+   return recycled;
+}
+
+// * Only environments that no closure or bound method held onto can be reused, the rest stay alive on their own
+void Interpreter::release_environment(Ref<Environment> environment)
+{
+   if (environment->reference_count() == 1) {
+      environment->reset(nullptr);
+      environment_pool.push_back(std::move(environment));
+   }
 }
 
-std::any Interpreter::visit_BinaryExpr(std::shared_ptr<Binary> expr)
+Value Interpreter::visit_BinaryExpr(Binary* expr)
 {
-   std::any right = evaluate(expr->right);
-   std::any left  = evaluate(expr->left);
+   Value right = evaluate(expr->right);
+   Value left  = evaluate(expr->left);
 
    switch (expr->op.type)
    {
       case GREATER:
          assert_number_operands(expr->op, left, right);
-         return std::any_cast<double>(left) >  std::any_cast<double>(right);
+         return left.as_number() >  right.as_number();
       case GREATER_EQUAL:
          assert_number_operands(expr->op, left, right);
-         return std::any_cast<double>(left) >= std::any_cast<double>(right);
+         return left.as_number() >= right.as_number();
       case LESS:
          assert_number_operands(expr->op, left, right);
-         return std::any_cast<double>(left) <  std::any_cast<double>(right);
+         return left.as_number() <  right.as_number();
       case LESS_EQUAL:
          assert_number_operands(expr->op, left, right);
-         return std::any_cast<double>(left) <= std::any_cast<double>(right);
+         return left.as_number() <= right.as_number();
       case BANG_EQUAL: 
-         return !is_equal(left, right);
+         return !left.equals(right);
       case EQUAL_EQUAL: 
-         return !is_equal(left, right);
+         return left.equals(right);
       case MINUS:
          assert_number_operands(expr->op, left, right);
-         return std::any_cast<double>(left) -  std::any_cast<double>(right);
+         return left.as_number() -  right.as_number();
       case SLASH:
          assert_number_operands(expr->op, left, right);
-         return std::any_cast<double>(left) /  std::any_cast<double>(right);
+         return left.as_number() /  right.as_number();
       case STAR:
          assert_number_operands(expr->op, left, right);
-         return std::any_cast<double>(left) *  std::any_cast<double>(right);
+         return left.as_number() *  right.as_number();
       
       case PLUS:
-         if (left.type() == typeid(double) && right.type() == typeid(double)) 
+         if (left.is_number() && right.is_number()) 
          {
-            return std::any_cast<double>(left) + std::any_cast<double>(right);
+            return left.as_number() + right.as_number();
          } 
 
-         if (left.type() == typeid(std::string) && right.type() == typeid(std::string)) 
+         if (left.is_string() && right.is_string()) 
          {
-            return std::any_cast<std::string>(left) + std::any_cast<std::string>(right);
+            return left.as_string() + right.as_string();
          }
          throw RuntimeError(expr->op, "Operands must be two numbers or two strings.");
       
@@ -106,343 +163,360 @@ std::any Interpreter::visit_BinaryExpr(std::shared_ptr<Binary> expr)
    }
 }
 
-std::any Interpreter::visit_GroupExpr(std::shared_ptr<Group> expr)
+Value Interpreter::visit_GroupExpr(Group* expr)
 {
    return evaluate(expr->expr_in);
 }
 
-std::any Interpreter::visit_LiteralExpr(std::shared_ptr<Literal> expr)
+Value Interpreter::visit_LiteralExpr(Literal* expr)
 {
    return expr->value;
 }
 
-std::any Interpreter::visit_LogicalExpr(std::shared_ptr<Logical> expr)
+Value Interpreter::visit_LogicalExpr(Logical* expr)
 {
-   std::any left = evaluate(expr->left);
+   Value left = evaluate(expr->left);
 
    if (expr->op.type == TokenType::OR)
    {
-      if (is_truthy(left)) { return left; }
+      if (left.is_truthy()) { return left; }
    }
    else
    {
-      if (!is_truthy(left)) { return left; }
+      if (!left.is_truthy()) { return left; }
    }
 
    return evaluate(expr->right);
 }
 
-std::any Interpreter::visit_UnaryExpr(std::shared_ptr<Unary> expr)
+Value Interpreter::visit_UnaryExpr(Unary* expr)
 {
-   std::any right = evaluate(expr->right);
+   Value right = evaluate(expr->right);
 
    switch (expr->op.type)
    {
    case MINUS:
       assert_number_operand(expr->op, right);
-      return std::any_cast<double>(right) * -1;
+      return -right.as_number();
    case BANG:
-      return !is_truthy(right); 
+      return !right.is_truthy(); 
    default:
       return nullptr;
    }
 }
 
-std::any Interpreter::visit_VariableExpr( std::shared_ptr<Variable> expr )
+Value Interpreter::visit_VariableExpr( Variable* expr )
 {
-   return look_up_variable(expr->name, expr);
+   return look_up_variable(expr->name, expr->resolution);
 }
 
-std::any Interpreter::visit_AssignExpr(std::shared_ptr<Assign> expr)
+Value Interpreter::visit_AssignExpr(Assign* expr)
 {
-   std::any value = evaluate(expr->value);
+   Value value = evaluate(expr->value);
    
-   if (locals.find(expr) != locals.end())
+   if (expr->resolution.is_local())
    {
-      int distance = locals[expr];
-      environment->assign_at(distance, expr->name, value);
+      environment->assign_at(expr->resolution.depth, expr->resolution.slot, value);
    }
    else {
-      global_environment->assign(expr->name, value);
+      global_environment->assign_at(0, global_slot(expr->name, expr->resolution), value);
    }
 
    return value;  
 }
 
-std::any Interpreter::visit_CallExpr(std::shared_ptr<Call> expr)
+Value Interpreter::visit_CallExpr(Call* expr)
 {
-   std::any callee = evaluate(expr->calle);
+   Value callee;
+   if (expr->property != nullptr)
+   {
+      // * instance.method() runs the method with the instance as "this", no bound method is created
+      Value object = evaluate(expr->property->object);
+      if (object.is_instance())
+      {
+         LoxFunction* method = object.as<LoxInstance>()->find_method(expr->property->name.lexeme, expr->property->cache);
+         if (method != nullptr) {
+            return call_function(method, method->new_frame(*this, object), expr);
+         }
+      }
+      callee = get_property(object, expr->property->name, expr->property->cache);
+   }
+   else if (Super* super = expr->super_property)
+   {
+      // * So does super.method()
+      int distance = super->resolution.depth;
+      Value object = environment->get_at(distance-1, 0);
+      LoxFunction* method = find_super_method(super, environment->get_at(distance, 0));
+      return call_function(method, method->new_frame(*this, object), expr);
+   }
+   else {
+      callee = evaluate(expr->calle);
+   }
 
-   std::vector<std::any> arguments;
-   for (const std::shared_ptr<Expr> &argument : expr->arguements)
+   if (callee.is_function())
    {
-      arguments.push_back(evaluate(argument));
+      LoxFunction* function = callee.as<LoxFunction>();
+      return call_function(function, function->new_frame(*this), expr);
    }
 
-   std::shared_ptr<LoxCallable> function;
-   if (callee.type() == typeid(std::shared_ptr<LoxFunction>)) {
-      function = std::any_cast<std::shared_ptr<LoxFunction>>(callee);
+   std::vector<Value> arguments;
+   arguments.reserve(expr->arguements.size());
+   for (Expr*argument : expr->arguements)
+   {
+      arguments.push_back(evaluate(argument));
    }
-   else if (callee.type() == typeid(std::shared_ptr<LoxClass>)) {
-      function = std::any_cast<std::shared_ptr<LoxClass>>(callee);
+
+   return call_callable(callee, std::move(arguments), expr->paren);
+}
+
+// * Lox functions get their arguments evaluated straight into the parameter slots of their frame
+Value Interpreter::call_function(LoxFunction* function, Ref<Environment> frame, Call* expr)
+{
+   for (Expr*argument : expr->arguements)
+   {
+      frame->define(evaluate(argument));
    }
-   else {
-      throw RuntimeError{expr->paren, "Can only call functions and classes."};
+
+   return call_frame(function, std::move(frame), expr->arguements.size(), expr->paren);
+}
+
+// * The arguments are already defined in the frame
+Value Interpreter::call_frame(LoxFunction* function, Ref<Environment> frame, int argument_count, const Token& paren)
+{
+   if (argument_count != function->arity()) {
+      throw RuntimeError{ paren, "Expected " + std::to_string(function->arity()) + " arguments but got " + std::to_string(argument_count) + "."}; }
+
+   return function->call(*this, std::move(frame));
+}
+
+// * Everything callable that is not a Lox function: classes and natives
+Value Interpreter::call_callable(const Value& callee, std::vector<Value> arguments, const Token& paren)
+{
+   if (!callee.is_callable()) {
+      throw RuntimeError{paren, "Can only call functions and classes."};
    }
+   LoxCallable* function = callee.as<LoxCallable>();
 
    if (static_cast<int>(arguments.size()) != function->arity()) {
-      throw RuntimeError{ expr->paren, "Expected " + std::to_string(function->arity()) + " arguments but got " + std::to_string(arguments.size()) + "."}; }
+      throw RuntimeError{ paren, "Expected " + std::to_string(function->arity()) + " arguments but got " + std::to_string(arguments.size()) + "."}; }
 
    return function->call(*this, std::move(arguments));
 }
 
-std::any Interpreter::visit_GetExpr(std::shared_ptr<Get> expr)
+Value Interpreter::visit_GetExpr(Get* expr)
 {
-   std::any object = evaluate(expr->object);
-   if (object.type() == typeid(std::shared_ptr<LoxInstance>))
+   return get_property(evaluate(expr->object), expr->name, expr->cache);
+}
+
+Value Interpreter::get_property(const Value& object, const Token& name, PropertyCache& cache)
+{
+   if (object.is_instance())
    {
-      return std::any_cast<std::shared_ptr<LoxInstance>>(object)->get(expr->name);
+      return object.as<LoxInstance>()->get(name, cache);
    }
 
-   throw new RuntimeError(expr->name, "Only instances have properties.");
-   return {};
+   throw RuntimeError(name, "Only instances have properties.");
 }
 
-std::any Interpreter::visit_SetExpr(std::shared_ptr<Set> expr)
+Value Interpreter::visit_SetExpr(Set* expr)
 {
-   std::any object = evaluate(expr->object);
+   Value object = evaluate(expr->object);
 
-   if (object.type() != typeid(std::shared_ptr<LoxInstance>)) {
-      throw new RuntimeError(expr->name, "Only instances have fields.");
+   if (!object.is_instance()) {
+      throw RuntimeError(expr->name, "Only instances have fields.");
    }
    
-   auto instance = std::any_cast<std::shared_ptr<LoxInstance>>(object);
-   std::any value = evaluate(expr->value);
-   instance->set(expr->name, value);
+   Value value = evaluate(expr->value);
+   object.as<LoxInstance>()->set(expr->name, value, expr->cache);
    
    return value;
 }
 
-std::any Interpreter::visit_SuperExpr(std::shared_ptr<Super> expr)
+Value Interpreter::visit_SuperExpr(Super* expr)
 {
-   int distance = locals[expr];
-   auto superclass =  std::any_cast< std::shared_ptr<LoxClass>>( environment->get_at(distance, "super" ) );
-   auto object = std::any_cast< std::shared_ptr<LoxInstance>>( environment->get_at(distance-1, "this" ) );
+   int distance = expr->resolution.depth;
+   Value superclass = environment->get_at(distance, 0);   // * "super" is the only slot of its environment
+   Value object = environment->get_at(distance-1, 0);     // * and so is "this"
 
-   std::shared_ptr<LoxFunction> method = superclass->find_method(expr->method.lexeme);
+   return find_super_method(expr, superclass)->bind(object);
+}
+
+LoxFunction* Interpreter::find_super_method(Super* expr, const Value& superclass)
+{
+   LoxFunction* method = superclass.as<LoxClass>()->find_method(expr->method.lexeme, expr->cache);
    if (method == nullptr) {
-      throw new RuntimeError(expr->method, "Undefined property '" + expr->method.lexeme + "'.");
+      throw RuntimeError(expr->method, "Undefined property '" + std::string(expr->method.lexeme) + "'.");
    }
-   return method->bind(object);
+   return method;
 }
 
-std::any Interpreter::visit_ThisExpr(std::shared_ptr<This> expr)
+Value Interpreter::visit_ThisExpr(This* expr)
 {
-   return look_up_variable(expr->keyword, expr);
+   return look_up_variable(expr->keyword, expr->resolution);
 }
 
-std::any Interpreter::visit_ExpressionStmt(std::shared_ptr<Expression> stmt)
+Completion Interpreter::visit_ExpressionStmt(Expression* stmt)
 {
    evaluate(stmt->expression);
    return {};
 }
 
-std::any Interpreter::visit_IfStmt(std::shared_ptr<If> stmt)
+Completion Interpreter::visit_IfStmt(If* stmt)
 {
-   if (is_truthy(evaluate(stmt->condition)))
+   if (evaluate(stmt->condition).is_truthy())
    {
-      execute(stmt->then_branch);
+      return execute(stmt->then_branch);
    }
    else if (stmt->else_branch != nullptr) {
-      execute(stmt->else_branch);
+      return execute(stmt->else_branch);
    }
    return {};
 }
 
-std::any Interpreter::visit_PrintStmt(std::shared_ptr<Print> stmt)
+Completion Interpreter::visit_PrintStmt(Print* stmt)
 {
-   std::any value = evaluate(stmt->expression);
-   std::cout << stringify(value) << "\n";
+   Value value = evaluate(stmt->expression);
+   out << value.to_string() << "\n";
    return {};
 }
 
-std::any Interpreter::visit_ReturnStmt(std::shared_ptr<Return> stmt)
+Completion Interpreter::visit_ReturnStmt(Return* stmt)
 {
-   std::any value = nullptr;
+   Value value = nullptr;
    if (stmt->value != nullptr) { 
       value = evaluate(stmt->value); 
    }  
-   throw LoxReturn{value};
+   return Completion{Completion::RETURN, value};
 }
 
-std::any Interpreter::visit_VarStmt(std::shared_ptr<Var> stmt)
+Completion Interpreter::visit_VarStmt(Var* stmt)
 {
-   std::any value = nullptr;
+   Value value = nullptr;
    if (stmt->initializer != nullptr) {
       value = evaluate(stmt->initializer);
    }
-   environment->define(stmt->name.lexeme, value);
+   define_variable(stmt->name, value);
 
    return {}; 
 }
 
-std::any Interpreter::visit_WhileStmt(std::shared_ptr<While> stmt)
+Completion Interpreter::visit_WhileStmt(While* stmt)
 {
-   while (is_truthy(evaluate(stmt->condition)))
+   while (evaluate(stmt->condition).is_truthy())
    {
-      execute(stmt->body);
+      count_back_edge();
+      Completion completion = execute(stmt->body);
+      if (completion.type == Completion::RETURN) { return completion; }
    }
 
    return {};
 }
 
-std::any Interpreter::visit_BlockStmt(std::shared_ptr<Block> stmt)
+Completion Interpreter::visit_BlockStmt(Block* stmt)
 {
-   execute_block(stmt->statements, std::make_shared<Environment>(environment));
-   return {};
+   Ref<Environment> block_environment = acquire_environment(environment);
+   Completion completion = execute_block(stmt->statements, block_environment);
+   release_environment(std::move(block_environment));
+   return completion;
 }
 
-std::any Interpreter::visit_ClassStmt(std::shared_ptr<Class> stmt)
+Completion Interpreter::visit_ClassStmt(Class* stmt)
 {
-   std::any superclass = nullptr;
+   Value superclass = nullptr;
    if (stmt->superclass != nullptr) {
       superclass = evaluate(stmt->superclass);
-      if (superclass.type() != typeid(std::shared_ptr<LoxClass>) )
+      if (!superclass.is_class())
       {
          throw RuntimeError(stmt->superclass->name, "Superclass must be a class.");
       }
    }
 
-   environment->define(stmt->name.lexeme, nullptr);
+   int slot = define_variable(stmt->name, nullptr);
 
    if (stmt->superclass != nullptr) {
-      environment = std::make_shared<Environment>(environment);
-      environment->define("super", superclass);
+      environment = Ref<Environment>{new Environment(environment)};
+      environment->define(superclass);
    }
 
-   std::map<std::string, std::shared_ptr<LoxFunction>> methods;
-   for (std::shared_ptr<Function> method : stmt->methods)
+   LoxClass::MethodTable methods;
+   for (Function* method : stmt->methods)
    {
-      auto function = std::make_shared<LoxFunction>(method, environment, method->name.lexeme == "init" );
-      methods[method->name.lexeme] = function; 
+      Ref<LoxFunction> function{new LoxFunction(method, environment, method->name.lexeme == "init" ? FunctionType::INITIALIZER : FunctionType::METHOD)};
+      methods[std::string(method->name.lexeme)] = function; 
    }
 
-   std::shared_ptr<LoxClass> temp = nullptr;
-   if (superclass.type() == typeid(std::shared_ptr<LoxClass>)) {
-      temp = std::any_cast<std::shared_ptr<LoxClass>>(superclass);
+   Ref<LoxClass> temp = nullptr;
+   if (superclass.is_class()) {
+      temp = superclass.as<LoxClass>();
    }
 
-   auto lox_class = std::make_shared<LoxClass>(stmt->name.lexeme, temp, methods); 
+   Ref<LoxClass> lox_class{new LoxClass(std::string(stmt->name.lexeme), temp, std::move(methods))}; 
 
    if (temp != nullptr) {
       environment = environment->enclosing;
    }
 
-   environment->assign(stmt->name, lox_class);
+   environment->assign_at(0, slot, lox_class);
    return {};
 }
 
-std::any Interpreter::visit_FunctionStmt(std::shared_ptr<Function> stmt)
+Completion Interpreter::visit_FunctionStmt(Function* stmt)
 {
-   auto function = std::make_shared<LoxFunction>(stmt, environment, false);
-   environment->define(stmt->name.lexeme, function);
+   Ref<LoxFunction> function{new LoxFunction(stmt, environment, FunctionType::FUNCTION)};
+   define_variable(stmt->name, function);
    return {};
 }
 
-// * All objects that are not nill or false are truthy *
-bool Interpreter::is_truthy(std::any object) 
+//* Globals are looked up by name, locals get the next slot which is the one the Resolver assigned to them
+int Interpreter::define_variable(const Token& name, Value value)
 {
-   if (object.type() == typeid(nullptr)) { return false; }
-   if (object.type() == typeid(bool)) 
-   {
-      return std::any_cast<bool>(object);
+   if (environment.get() == global_environment.get()) {
+      return environment->define(std::string(name.lexeme), value);
    }
-   return true;
+   return environment->define(value);
 }
 
-bool Interpreter::is_equal(std::any a, std::any b)
+void Interpreter::count_back_edge()
 {
-   if (a.type() == typeid(nullptr) && b.type() == typeid(nullptr)) { return true; }
-   if (a.type() == typeid(nullptr)) { return false; }
-
-   if (a.type() == typeid(std::string) && b.type() == typeid(std::string)) 
-   {
-      return std::any_cast<std::string>(a) == std::any_cast<std::string>(b);
-   }
-   if (a.type() == typeid(double) && b.type() == typeid(double)) 
-   {
-      return std::any_cast<double>(a) == std::any_cast<double>(b);
-   }
-   if (a.type() == typeid(bool) && b.type() == typeid(bool)) 
-   {
-      return std::any_cast<bool>(a) == std::any_cast<bool>(b);
+   collect_if_due();
+   if (current_function != nullptr and current_function->jit.hotness < Jit::HOT_THRESHOLD) {
+      ++current_function->jit.hotness;
    }
-    
-   return false;
 }
 
-void Interpreter::assert_number_operand(Token op, std::any object)
+void Interpreter::assert_number_operand(const Token& op, const Value& object)
 {
-   if ( object.type() == typeid(double) ) { return; }
+   if ( object.is_number() ) { return; }
    else { 
       throw RuntimeError(op, "Operand must be a number."); 
    }
 }
 
-void Interpreter::assert_number_operands(Token op, std::any left, std::any right)
+void Interpreter::assert_number_operands(const Token& op, const Value& left, const Value& right)
 {
-   if ( left.type() == typeid(double) and right.type() == typeid(double))
+   if ( left.is_number() and right.is_number())
    { return; }
    else {
       throw RuntimeError(op, "Operand must be a number."); 
    }
 }
 
-std::string Interpreter::stringify(std::any object)
+Value Interpreter::look_up_variable(const Token& name, Resolution& resolution)
 {
-   if (object.type() == typeid(nullptr)) { return "nil"; }
-
-   if (object.type() == typeid(double))
+   if (resolution.is_local())
    {
-      std::string text = std::to_string(std::any_cast<double>(object));
-      if (text[text.length() - 2] == '.' && text[text.length() - 1] == '0') {
-        text = text.substr(0, text.length() - 2);
-      }
-   return text;
-   }
-
-   if (object.type() == typeid(std::string)) {
-      return std::any_cast<std::string>(object);
+      return environment->get_at(resolution.depth, resolution.slot);
    }
-   
-   if (object.type() == typeid(bool)) {
-      return std::any_cast<bool>(object) ? "true" : "false";
-   }
-
-   if (object.type() == typeid(std::shared_ptr<LoxFunction>)) {
-      return std::any_cast<
-          std::shared_ptr<LoxFunction>>(object)->to_string();
-   }
-   if (object.type() == typeid(std::shared_ptr<LoxClass>)) {
-      return std::any_cast<
-         std::shared_ptr<LoxClass>>(object)->to_string();
-   }
-   if (object.type() == typeid(std::shared_ptr<LoxInstance>)) {
-      return std::any_cast<
-         std::shared_ptr<LoxInstance>>(object)->to_string();
+   else {
+      return global_environment->get_at(0, global_slot(name, resolution));
    }
-
-   return "Error in stringify: object type not recognized.";
 }
 
-std::any Interpreter::look_up_variable(Token name, std::shared_ptr<Expr> expr)
+//* Only the first execution of a global access site looks the name up, after that the slot is cached on the node
+int Interpreter::global_slot(const Token& name, Resolution& resolution)
 {
-   if (locals.find(expr) != locals.end())
-   {
-      int distance = locals[expr];
-      return environment->get_at(distance, name.lexeme);
-   }
-   else {
-      return global_environment->get(name);
+   if (resolution.slot < 0) {
+      resolution.slot = global_environment->slot_of(name);
    }
+   return resolution.slot;
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "headers/Isolate.h"
+#include "headers/Scanner.h"
+#include "headers/Parser.h"
+#include "headers/ParallelParser.h"
+#include "headers/Resolver.h"
+#include "headers/Optimizer.h"
+#include "headers/Compiler.h"
+#include "headers/ClosureCompiler.h"
+#include "headers/CEmitter.h"
+#include "headers/ProgramCache.h"
+
+#include <algorithm>
+
+Isolate::Isolate(const Options& options, std::ostream& out, std::ostream& err)
+   : options(options), out(out), errors(err)
+{
+   Heap::Scope scope{heap}; // * The globals' environment is tracked
+   interpreter = std::make_unique<Interpreter>(out, errors, heap);
+   interpreter->jit.enabled = options.jit;
+   interpreter->jit.log = options.jit_log;
+   vm = std::make_unique<VM>(out, errors, heap);
+}
+
+// * The cycles left once the runtime is gone are collected while the code their functions point into is still there
+Isolate::~Isolate()
+{
+   vm.reset();
+   interpreter.reset();
+   heap.collect();
+   programs.clear();
+}
+
+// * Scripts run from a file go through the ProgramCache, the REPL's lines (no path) are always compiled
+void Isolate::run(std::unique_ptr<SourceText> source, const std::string& path)
+{
+   // * Functions and classes keep pointing into the AST they were declared in, so every program stays alive
+   programs.push_back(std::make_unique<Program>());
+   if (not build(source->view(), programs.back(), path)) {
+      return; }
+   Program& program = *programs.back();
+   program.source = std::move(source);
+   execute(program);
+}
+
+/*
+   --stream: instead of the whole script, one top level declaration at a time is scanned, compiled and run like a line of the REPL,
+   so output starts right away and memory doesn't grow with the script. A declaration is dropped once it ran,
+   unless it declared a function or a class, they keep pointing into its AST.
+   After a compile error nothing runs anymore but the rest is still compiled to report its errors, the cache is not used
+*/
+void Isolate::run_stream(std::unique_ptr<SourceText> source)
+{
+   SourceText& text = *source;
+   programs.push_back(std::make_unique<Program>());
+   programs.back()->source = std::move(source); // * Every declaration's tokens point into it
+
+   Scanner scanner(text.view(), errors);
+   while (true)
+   {
+      auto program = std::make_unique<Program>();
+      program->tokens = scanner.scan_declaration();
+      if (program->tokens.size() == 1) {
+         break; }
+      if (not parse(*program)) {
+         continue; }
+
+      execute(*program);
+      if (errors.had_runtime_error) {
+         return; }
+
+      const Token& last = program->tokens[program->tokens.size() - 2];
+      text.release_before(last.lexeme.data() + last.lexeme.size() - text.view().data());
+      bool declares = std::any_of(program->tokens.begin(), program->tokens.end(),
+                                  [](const Token& token) { return token.type == FUN or token.type == CLASS; });
+      if (declares) {
+         programs.push_back(std::move(program)); }
+   }
+}
+
+std::shared_ptr<const ProgramImage> Isolate::compile(std::unique_ptr<SourceText> source, const std::string& path)
+{
+   auto program = std::make_unique<Program>();
+   if (not build(source->view(), program, path)) {
+      return nullptr; }
+
+   auto image = std::make_shared<ProgramImage>();
+   image->tree = ProgramCache{}.encode(source->view(), *program);
+   image->source = std::move(source);
+   return image;
+}
+
+// * Reads the image, nothing else, so other threads can be running it too
+void Isolate::run(const ProgramImage& image)
+{
+   programs.push_back(std::make_unique<Program>());
+   std::string_view text = image.source->view();
+   ProgramCache decoder;
+   if (not decoder.decode(text, image.tree, *programs.back()))
+   {
+      programs.back() = std::make_unique<Program>(); // * An image from another build of the interpreter, say
+      if (not compile_source(text, *programs.back())) {
+         return; }
+   }
+   Program& program = *programs.back();
+   program.source = image.source;
+   execute(program);
+}
+
+// * Everything the program creates is tracked by this isolate's heap
+void Isolate::execute(Program& program)
+{
+   Heap::Scope scope{heap};
+   if (options.backend == Backend::VM) {
+      Compiler compiler{*vm, program, errors};
+      VMFunction* script = compiler.compile();
+      if (errors.had_error) { 
+         return; }
+      vm->interpret(script);
+   }
+   else if (options.backend == Backend::EMIT_C) {
+      CEmitter emitter;
+      out << emitter.emit(program.statements);
+   }
+   else if (options.backend == Backend::CLOSURES) {
+      ClosureCompiler compiler{program.arena};
+      interpreter->interpret(compiler.compile(program.statements));
+   }
+   else {
+      interpreter->interpret(program.statements);
+   }
+}
+
+// * Loads the program from the cache next to the file at path, or compiles it and stores it there, false if it has errors
+bool Isolate::build(std::string_view source, std::unique_ptr<Program>& program, const std::string& path)
+{
+   bool cached = options.use_cache and not path.empty();
+   ProgramCache cache{path};
+   if (cached)
+   {
+      if (cache.load(source, *program)) {
+         return true; }
+      program = std::make_unique<Program>(); // * Drops whatever the failed load left behind
+   }
+   if (not compile_source(source, *program)) {
+      return false; }
+   if (cached) {
+      cache.store(source, *program); }
+   return true;
+}
+
+// * Scans, parses, resolves and optimizes the source into program, false if it has errors
+bool Isolate::compile_source(std::string_view source, Program& program)
+{
+   Scanner scanner(source, errors);
+   program.tokens = scanner.scan_tokens();
+   return parse(program);
+}
+
+// * Parses, resolves and optimizes the program's tokens, false if it has errors or an earlier one had
+bool Isolate::parse(Program& program)
+{
+   if (options.parallel_parse) {
+      ParallelParser parser{program.tokens, program.arena, errors};
+      program.statements = parser.parse();
+   }
+   else {
+      Parser parser{program.tokens, program.arena, errors};
+      program.statements = parser.parse();
+   }
+   if (errors.had_error) { 
+      return false; }
+
+   Resolver resolver{errors};
+   resolver.resolve(program.statements);
+
+   if (errors.had_error) { 
+      return false; }
+
+   Optimizer optimizer{program.arena};
+   program.statements = optimizer.optimize(program.statements);
+   return true;
+}
\ No newline at end of file
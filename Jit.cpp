@@ -0,0 +1,183 @@
+#include "headers/Jit.h"
+#include "headers/JitCompiler.h"
+#include "headers/LoxFunction.h"
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define LOX_JIT_SUPPORTED 1
+#endif
+
+JitFunction::JitFunction(Function* declaration)
+   : declaration(declaration)
+{}
+
+JitFunction::~JitFunction()
+{
+#ifdef LOX_JIT_SUPPORTED
+   if (memory != nullptr) {
+      munmap(memory, mapped_size);
+   }
+#endif
+}
+
+// * The code is written while the pages are writable and only then made executable, never both at once
+bool JitFunction::install(const std::vector<std::uint8_t>& code)
+{
+#ifdef LOX_JIT_SUPPORTED
+   std::size_t page = sysconf(_SC_PAGESIZE);
+   std::size_t size = (code.size() + page - 1) / page * page;
+   void* pages = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (pages == MAP_FAILED) {
+      return false;
+   }
+
+   std::memcpy(pages, code.data(), code.size());
+   if (mprotect(pages, size, PROT_READ | PROT_EXEC) != 0) {
+      munmap(pages, size);
+      return false;
+   }
+
+   memory = pages;
+   mapped_size = size;
+   code_size = code.size();
+   entry = reinterpret_cast<JitEntry>(memory);
+   return true;
+#else
+   return false;
+#endif
+}
+
+Jit::Jit(Environment& globals, ErrorReporter& errors)
+   : globals(globals), errors(errors)
+{}
+
+bool Jit::run(Function* declaration, Environment& frame, Value& result)
+{
+   JitProfile& profile = declaration->jit;
+   if (profile.state == JitProfile::COLD)
+   {
+      if (++profile.hotness < HOT_THRESHOLD) { 
+         return false; }
+      compile(declaration);
+   }
+   if (profile.state != JitProfile::COMPILED) { 
+      return false; }
+
+   double arguments[MAX_ARGUMENTS];
+   for (std::size_t i = 0; i < declaration->params.size(); ++i)
+   {
+      Value argument = frame.get_at(0, i);
+      if (!argument.is_number()) {
+         deoptimize(declaration, "argument '" + std::string(declaration->params[i]->lexeme) + "' is not a number");
+         return false;
+      }
+      arguments[i] = argument.as_number();
+   }
+
+   JitContext context{&globals};
+   double value = profile.code->entry(&context, arguments);
+   if (context.bailout) {
+      deoptimize(context.culprit->declaration, context.reason);
+      return false;
+   }
+
+   result = value;
+   return true;
+}
+
+// * A function being compiled already counts as compiled, so recursive calls find it
+JitFunction* Jit::compile(Function* declaration)
+{
+   JitProfile& profile = declaration->jit;
+   if (profile.state == JitProfile::COMPILED) { 
+      return profile.code; }
+   if (profile.state == JitProfile::REJECTED) { 
+      return nullptr; }
+
+   functions.push_back(std::make_unique<JitFunction>(declaration));
+   JitFunction* function = functions.back().get();
+   profile.state = JitProfile::COMPILED;
+   profile.code = function;
+
+   std::string reason;
+#ifdef LOX_JIT_SUPPORTED
+   try {
+      JitCompiler compiler{*this, globals, *function};
+      if (!function->install(compiler.compile())) {
+         reason = "no executable memory";
+      }
+   } catch (const JitCompiler::Unsupported& unsupported) {
+      reason = "it " + unsupported.reason;
+   }
+#else
+   reason = "the JIT only runs on x86-64 Linux";
+#endif
+
+   if (!reason.empty())
+   {
+      profile.state = JitProfile::REJECTED;
+      profile.code = nullptr;
+      report(declaration, "not compiled, " + reason);
+      return nullptr;
+   }
+
+   report(declaration, "compiled to " + std::to_string(function->size()) + " bytes after " + std::to_string(profile.hotness) + " calls and loop iterations");
+   return function;
+}
+
+void Jit::deoptimize(Function* declaration, const std::string& reason)
+{
+   if (declaration->jit.state == JitProfile::REJECTED) {
+      return; } // * Its code is still called by compiled callers, and can fail again
+   declaration->jit.state = JitProfile::REJECTED;
+   declaration->jit.code = nullptr;
+   report(declaration, "deoptimized, " + reason);
+}
+
+void Jit::report(const Function* declaration, const std::string& message)
+{
+   if (log) {
+      errors.note("[jit] " + std::string(declaration->name.lexeme) + " (line " + std::to_string(declaration->name.line) + "): " + message);
+   }
+}
+
+double Jit::call(JitContext* context, JitCallSite* site, const double* arguments)
+{
+   Value callee = context->globals->get_at(0, site->global_slot);
+   if (!callee.is_function() or callee.as<LoxFunction>()->declaration != site->declaration) 
+   {
+      context->bailout = true;
+      context->reason = "a call site's global no longer holds the function it was compiled for";
+      context->culprit = site->caller;
+      return 0;
+   }
+   if (site->target->entry == nullptr)
+   {
+      context->bailout = true;
+      context->reason = "it calls a function that could not be compiled";
+      context->culprit = site->caller;
+      return 0;
+   }
+   if (context->depth >= MAX_DEPTH)
+   {
+      context->bailout = true;
+      context->reason = "calls nested too deep for native code";
+      context->culprit = site->caller;
+      return 0;
+   }
+
+   ++context->depth;
+   double result = site->target->entry(context, arguments);
+   --context->depth;
+   return result;
+}
+
+double Jit::fall_off_end(JitContext* context, JitFunction* function, const double*)
+{
+   context->bailout = true;
+   context->reason = "it returned nil";
+   context->culprit = function;
+   return 0;
+}
\ No newline at end of file
@@ -0,0 +1,389 @@
+#include "headers/JitCompiler.h"
+#include "headers/LoxFunction.h"
+#include "headers/RuntimeError.h"
+#include <cstddef>
+
+JitCompiler::JitCompiler(Jit& jit, Environment& globals, JitFunction& function)
+   : jit(jit), globals(globals), function(function)
+{}
+
+// * Parameters take the first slots, the body shares their scope like it does in the Resolver
+std::vector<std::uint8_t> JitCompiler::compile()
+{
+   Function* declaration = function.declaration;
+
+   assembler.prologue();
+   scopes.emplace_back();
+   for (std::size_t i = 0; i < declaration->params.size(); ++i)
+   {
+      assembler.load_argument(i);
+      assembler.store_slot(declare());
+   }
+
+   compile(declaration->body);
+
+   // * Falling off the end returns nil, which is not a number
+   assembler.call(reinterpret_cast<const void*>(&Jit::fall_off_end), &function);
+   assembler.bind(exit);
+   assembler.epilogue();
+   assembler.set_frame_size(slot_count);
+   return assembler.code;
+}
+
+void JitCompiler::compile(Expr* expr)
+{
+   expr->accept(*this);
+}
+
+void JitCompiler::compile(Stmt* stmt)
+{
+   stmt->accept(*this);
+}
+
+void JitCompiler::compile(const std::vector<Stmt*>& statements)
+{
+   for (Stmt* stmt : statements) {
+      compile(stmt);
+   }
+}
+
+void JitCompiler::push()
+{
+   assembler.push();
+   ++pushed;
+}
+
+void JitCompiler::pop_operands()
+{
+   assembler.pop_operands();
+   --pushed;
+}
+
+int JitCompiler::declare()
+{
+   scopes.back().push_back(slot_count);
+   return slot_count++;
+}
+
+int JitCompiler::slot_of(const Token& name, const Resolution& resolution)
+{
+   if (!resolution.is_local()) {
+      throw Unsupported{"uses the global '" + std::string(name.lexeme) + "'"};
+   }
+
+   int scope = static_cast<int>(scopes.size()) - 1 - resolution.depth;
+   if (scope < 0) {
+      throw Unsupported{"uses '" + std::string(name.lexeme) + "' from an enclosing function"};
+   }
+   return scopes[scope][resolution.slot];
+}
+
+// * Jumps to target when the truthiness of the condition is when. Numbers are always truthy
+void JitCompiler::branch(Expr* condition, bool when, Assembler::Label& target)
+{
+   if (auto group = dynamic_cast<Group*>(condition)) {
+      branch(group->expr_in, when, target);
+      return;
+   }
+
+   if (auto literal = dynamic_cast<Literal*>(condition))
+   {
+      if (literal->value.is_truthy() == when) {
+         assembler.jump(target);
+      }
+      return;
+   }
+
+   if (auto unary = dynamic_cast<Unary*>(condition); unary != nullptr and unary->op.type == BANG) {
+      branch(unary->right, !when, target);
+      return;
+   }
+
+   if (auto logical = dynamic_cast<Logical*>(condition))
+   {
+      // * or jumps as soon as an operand is truthy, and as soon as one is falsy
+      bool decides = logical->op.type == TokenType::OR;
+      if (when == decides) {
+         branch(logical->left, when, target);
+         branch(logical->right, when, target);
+      }
+      else {
+         Assembler::Label skip;
+         branch(logical->left, decides, skip);
+         branch(logical->right, when, target);
+         assembler.bind(skip);
+      }
+      return;
+   }
+
+   auto binary = dynamic_cast<Binary*>(condition);
+   if (binary == nullptr)
+   {
+      compile(condition);
+      if (when) { assembler.jump(target); }
+      return;
+   }
+
+   // * ucomisd reports unordered (a NaN operand) as below and equal with parity set, every comparison with a NaN is false
+   Assembler::Label skip;
+   switch (binary->op.type)
+   {
+      case LESS:
+      case LESS_EQUAL:
+      case GREATER:
+      case GREATER_EQUAL:
+      {
+         compile(binary->left);
+         push();
+         compile(binary->right);
+         pop_operands();
+         bool less = binary->op.type == LESS or binary->op.type == LESS_EQUAL;
+         bool strict = binary->op.type == LESS or binary->op.type == GREATER;
+         assembler.compare(less);
+         if (strict) { assembler.jump_if(when ? Assembler::ABOVE : Assembler::BELOW_EQUAL, target); }
+         else        { assembler.jump_if(when ? Assembler::ABOVE_EQUAL : Assembler::BELOW, target); }
+         return;
+      }
+      case EQUAL_EQUAL:
+      case BANG_EQUAL:
+      {
+         compile(binary->left);
+         push();
+         compile(binary->right);
+         pop_operands();
+         assembler.compare(false);
+         if ((binary->op.type == EQUAL_EQUAL) == when) {
+            assembler.jump_if(Assembler::PARITY, skip);
+            assembler.jump_if(Assembler::EQUAL, target);
+            assembler.bind(skip);
+         }
+         else {
+            assembler.jump_if(Assembler::NOT_EQUAL, target);
+            assembler.jump_if(Assembler::PARITY, target);
+         }
+         return;
+      }
+      default:
+         compile(condition);
+         if (when) { assembler.jump(target); }
+   }
+}
+
+Value JitCompiler::visit_BinaryExpr(Binary* expr)
+{
+   switch (expr->op.type)
+   {
+      case PLUS: case MINUS: case STAR: case SLASH:
+         break;
+      default:
+         throw Unsupported{"uses the result of '" + std::string(expr->op.lexeme) + "' as a value"};
+   }
+
+   compile(expr->left);
+   push();
+   compile(expr->right);
+   pop_operands();
+
+   switch (expr->op.type)
+   {
+      case PLUS:  assembler.add();      break;
+      case MINUS: assembler.subtract(); break;
+      case STAR:  assembler.multiply(); break;
+      default:    assembler.divide();   break;
+   }
+   return nullptr;
+}
+
+Value JitCompiler::visit_GroupExpr(Group* expr)
+{
+   compile(expr->expr_in);
+   return nullptr;
+}
+
+Value JitCompiler::visit_LiteralExpr(Literal* expr)
+{
+   if (!expr->value.is_number()) {
+      throw Unsupported{"uses the value " + expr->value.to_string()};
+   }
+   assembler.load_constant(expr->value.as_number());
+   return nullptr;
+}
+
+Value JitCompiler::visit_UnaryExpr(Unary* expr)
+{
+   if (expr->op.type != MINUS) {
+      throw Unsupported{"uses the result of '" + std::string(expr->op.lexeme) + "' as a value"};
+   }
+   compile(expr->right);
+   assembler.negate();
+   return nullptr;
+}
+
+Value JitCompiler::visit_VariableExpr(Variable* expr)
+{
+   assembler.load_slot(slot_of(expr->name, expr->resolution));
+   return nullptr;
+}
+
+Value JitCompiler::visit_AssignExpr(Assign* expr)
+{
+   int slot = slot_of(expr->name, expr->resolution);
+   compile(expr->value);
+   assembler.store_slot(slot);
+   return nullptr;
+}
+
+Value JitCompiler::visit_LogicalExpr(Logical* expr)
+{
+   throw Unsupported{"uses the result of '" + std::string(expr->op.lexeme) + "' as a value"};
+}
+
+// * Only calls to global functions the JIT can compile as well, the call site checks the global still holds the same function
+Value JitCompiler::visit_CallExpr(Call* expr)
+{
+   auto variable = dynamic_cast<Variable*>(expr->calle);
+   if (variable == nullptr or variable->resolution.is_local()) {
+      throw Unsupported{"calls something other than a global function"};
+   }
+
+   int global_slot;
+   try {
+      global_slot = globals.slot_of(variable->name);
+   } catch (const RuntimeError&) {
+      throw Unsupported{"calls '" + std::string(variable->name.lexeme) + "', which is not defined yet"};
+   }
+
+   Value callee = globals.get_at(0, global_slot);
+   if (!callee.is_function() or callee.as<LoxFunction>()->type != FunctionType::FUNCTION) {
+      throw Unsupported{"calls '" + std::string(variable->name.lexeme) + "', which is not a function"};
+   }
+   Function* declaration = callee.as<LoxFunction>()->declaration;
+   if (declaration->params.size() != expr->arguements.size()) {
+      throw Unsupported{"calls '" + std::string(variable->name.lexeme) + "' with the wrong number of arguments"};
+   }
+
+   JitFunction* target = jit.compile(declaration);
+   if (target == nullptr) {
+      throw Unsupported{"calls '" + std::string(variable->name.lexeme) + "', which can not be compiled"};
+   }
+
+   function.call_sites.push_back(std::make_unique<JitCallSite>(JitCallSite{global_slot, declaration, target, &function}));
+   JitCallSite* site = function.call_sites.back().get();
+
+   // * The arguments are pushed last to first, so the first one ends up at rsp where the call passes them from
+   int padding = (pushed + expr->arguements.size()) % 2;
+   if (padding) {
+      assembler.grow_stack(8);
+   }
+   for (auto argument = expr->arguements.rbegin(); argument != expr->arguements.rend(); ++argument)
+   {
+      compile(*argument);
+      push();
+   }
+
+   assembler.call(reinterpret_cast<const void*>(&Jit::call), site);
+   assembler.shrink_stack(8 * (expr->arguements.size() + padding));
+   pushed -= expr->arguements.size();
+   assembler.jump_if_flag(offsetof(JitContext, bailout), exit);
+   return nullptr;
+}
+
+Value JitCompiler::visit_GetExpr(Get* expr)
+{
+   throw Unsupported{"uses the property '" + std::string(expr->name.lexeme) + "'"};
+}
+
+Value JitCompiler::visit_SetExpr(Set* expr)
+{
+   throw Unsupported{"sets the property '" + std::string(expr->name.lexeme) + "'"};
+}
+
+Value JitCompiler::visit_ThisExpr(This*)
+{
+   throw Unsupported{"uses 'this'"};
+}
+
+Value JitCompiler::visit_SuperExpr(Super*)
+{
+   throw Unsupported{"uses 'super'"};
+}
+
+Completion JitCompiler::visit_ExpressionStmt(Expression* stmt)
+{
+   compile(stmt->expression);
+   return {};
+}
+
+Completion JitCompiler::visit_PrintStmt(Print*)
+{
+   throw Unsupported{"prints"};
+}
+
+Completion JitCompiler::visit_VarStmt(Var* stmt)
+{
+   if (stmt->initializer == nullptr) {
+      throw Unsupported{"declares '" + std::string(stmt->name.lexeme) + "' without a value"};
+   }
+   compile(stmt->initializer);
+   assembler.store_slot(declare());
+   return {};
+}
+
+Completion JitCompiler::visit_BlockStmt(Block* stmt)
+{
+   scopes.emplace_back();
+   compile(stmt->statements);
+   scopes.pop_back();
+   return {};
+}
+
+Completion JitCompiler::visit_IfStmt(If* stmt)
+{
+   Assembler::Label else_branch;
+   Assembler::Label end;
+
+   branch(stmt->condition, false, else_branch);
+   compile(stmt->then_branch);
+   if (stmt->else_branch != nullptr) {
+      assembler.jump(end);
+   }
+   assembler.bind(else_branch);
+   if (stmt->else_branch != nullptr) {
+      compile(stmt->else_branch);
+   }
+   assembler.bind(end);
+   return {};
+}
+
+Completion JitCompiler::visit_WhileStmt(While* stmt)
+{
+   Assembler::Label start;
+   Assembler::Label end;
+
+   assembler.bind(start);
+   branch(stmt->condition, false, end);
+   compile(stmt->body);
+   assembler.jump(start);
+   assembler.bind(end);
+   return {};
+}
+
+Completion JitCompiler::visit_FunctionStmt(Function* stmt)
+{
+   throw Unsupported{"declares the function '" + std::string(stmt->name.lexeme) + "'"};
+}
+
+Completion JitCompiler::visit_ReturnStmt(Return* stmt)
+{
+   if (stmt->value == nullptr) {
+      throw Unsupported{"returns nil"};
+   }
+   compile(stmt->value);
+   assembler.jump(exit);
+   return {};
+}
+
+Completion JitCompiler::visit_ClassStmt(Class* stmt)
+{
+   throw Unsupported{"declares the class '" + std::string(stmt->name.lexeme) + "'"};
+}
\ No newline at end of file
@@ -1,108 +1,169 @@
 #include "headers/Lox.h"
-#include "headers/Scanner.h"
-#include "headers/Parser.h"
-#include "headers/AST_printer.h"
-#include "headers/Resolver.h"
+#include "headers/Pool.h"
+#include "headers/ScannerBenchmark.h"
 
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream> 
+#include <sstream>
+#include <thread>
 #include <vector>
 
-bool Lox::had_error = false;
-bool Lox::had_runtime_error = false;
-Interpreter Lox::interpreter{};
-
 void Lox::run_script(int argc, char const *argv[])
 {
-   if (argc > 2) {
-      std::cout << "Usage: jlox [script]" << std::endl;
+   Isolate::Options options;
+   Settings settings;
+   int first = 1;
+   bool bench_scanner = false;
+   for (; first < argc and std::string(argv[first]).rfind("--", 0) == 0; ++first)
+   {
+      std::string flag = argv[first];
+      if (flag == "--closures") {
+         options.backend = Isolate::Backend::CLOSURES; }
+      else if (flag == "--vm") { 
+         options.backend = Isolate::Backend::VM; }
+      else if (flag == "--emit-c") {
+         options.backend = Isolate::Backend::EMIT_C; }
+      else if (flag == "--no-cache") {
+         options.use_cache = false; }
+      else if (flag == "--stream") {
+         settings.stream = true; }
+      else if (flag == "--parallel-parse") {
+         options.parallel_parse = true; }
+      else if (flag == "--isolates" and first + 1 < argc) {
+         settings.isolates = std::atoi(argv[++first]); }
+      else if (flag == "--gc-stats") {
+         settings.gc_stats = true; }
+      else if (flag == "--alloc-stats") {
+         settings.alloc_stats = true; }
+      else if (flag == "--no-jit") {
+         options.jit = false; }
+      else if (flag == "--jit-log") {
+         options.jit_log = true; }
+      else if (flag == "--bench-scanner") {
+         bench_scanner = true; }
+      else {
+         std::cout << "Unknown option: " << flag << std::endl;
+         std::exit(64);
+      }
+   }
+
+   if (settings.stream and options.backend == Isolate::Backend::EMIT_C) {
+      std::cout << "--stream can't be combined with --emit-c, it needs the whole program" << std::endl;
+      std::exit(64);
+   }
+   if (settings.stream and settings.isolates != 1) {
+      std::cout << "--stream can't be combined with --isolates, they run a compiled program" << std::endl;
+      std::exit(64);
+   }
+   if (argc - first > 1 or settings.isolates < 1) {
+      std::cout << "Usage: jlox [--closures|--vm|--emit-c] [--no-cache] [--stream] [--parallel-parse] [--isolates N] [--no-jit] [--jit-log] [--gc-stats] [--alloc-stats] [--bench-scanner] [script]" << std::endl;
       std::exit(64);
    } 
-   else if (argc == 2) {
-      std::cout << "Running from file at: " << argv[1] << std::endl;
-      run_file(argv[1]);
+   else if (bench_scanner) {
+      ScannerBenchmark::run(argc - first == 1 ? argv[first] : "");
+   }
+   else if (argc - first == 1) {
+      if (options.backend != Isolate::Backend::EMIT_C) {
+         std::cout << "Running from file at: " << argv[first] << std::endl; }
+      run_file(argv[first], options, settings);
    }
    else {
-      run_prompt();
+      run_prompt(options, settings);
    }
 }
 
-// ? If this method of reading strings is too slow we may need to update the method
-void Lox::run_file(std::string path)
+void Lox::run_file(const std::string& path, const Isolate::Options& options, const Settings& settings)
 {
-   std::ifstream file(path);
-   std::stringstream string_buffer;
-   string_buffer << file.rdbuf();
-   run(string_buffer.str());
+   std::unique_ptr<SourceText> source = SourceText::open(path);
+   if (source == nullptr) {
+      std::cerr << "Could not read file '" << path << "': " << std::strerror(errno) << "." << std::endl;
+      exit(66);
+   }
+   if (settings.isolates > 1) {
+      run_isolates(std::move(source), path, options, settings);
+      return;
+   }
+
+   Isolate isolate{options, std::cout, std::cerr};
+   if (settings.stream) {
+      isolate.run_stream(std::move(source)); }
+   else {
+      isolate.run(std::move(source), path); }
+   print_stats(isolate, settings, std::cerr);
 
-   if (had_error){
+   if (isolate.had_error()){
+      exit(65);
+   }
+   if (isolate.had_runtime_error()) {
+      exit(70);
+   }
+}
+
+/*
+   --isolates N: the script is compiled once, then run N times at the same time, each run in its own Isolate on its own thread
+   sharing the compiled ProgramImage. What the runs print is kept apart and written out once they all ended, in order,
+   so the output is the same as running the script N times one after the other. --gc-stats and --alloc-stats are per run
+*/
+void Lox::run_isolates(std::unique_ptr<SourceText> source, const std::string& path, const Isolate::Options& options, const Settings& settings)
+{
+   std::shared_ptr<const ProgramImage> image = Isolate{options, std::cout, std::cerr}.compile(std::move(source), path);
+   if (image == nullptr) {
       exit(65);
    }
+
+   struct Run {
+      std::ostringstream out;
+      std::ostringstream err;
+      bool had_runtime_error = false;
+   };
+   std::vector<Run> runs(settings.isolates);
+   std::vector<std::thread> threads;
+   for (Run& run : runs) {
+      threads.emplace_back([&run, &image, &options, &settings]() {
+         Isolate isolate{options, run.out, run.err};
+         isolate.run(*image);
+         print_stats(isolate, settings, run.err);
+         run.had_runtime_error = isolate.had_runtime_error();
+      });
+   }
+
+   bool had_runtime_error = false;
+   for (std::size_t i = 0; i < runs.size(); ++i) {
+      threads[i].join();
+      std::cout << runs[i].out.str() << std::flush;
+      std::cerr << runs[i].err.str();
+      had_runtime_error = had_runtime_error or runs[i].had_runtime_error;
+   }
    if (had_runtime_error) {
       exit(70);
    }
 }
 
-void Lox::run_prompt()
+void Lox::run_prompt(const Isolate::Options& options, const Settings& settings)
 {
+   Isolate isolate{options, std::cout, std::cerr};
    std::string input;
    while(1)
    {
       std::cout << ">";
       std::getline(std::cin, input);
       if (input == "exit") { 
+         print_stats(isolate, settings, std::cerr);
          std::cout << "terminated";
          break;
       }
-      run(input);
-      had_error = false;
-   }
-}
-
-void Lox::run(std::string source)
-{
-   Scanner scanner(source);
-   std::vector<Token> tokens = scanner.scan_tokens();
-   Parser parser{tokens};
-   std::vector<std::shared_ptr<Stmt>> statements = parser.parse();
-   if (had_error) { 
-      return; }
-
-   Resolver resolver(interpreter);
-   resolver.resolve(statements);
-
-   if (had_error) { 
-      return; }
-   interpreter.interpret(statements);
-}
-
-void Lox::error(int line, std::string message)
-{
-   report(line, "", message);
-}
-
-void Lox::report(int line, std::string where,  std::string message)
-{
-   std::cerr << "[line " << line << "] Error" << where << ": " << message << "\n";
-   had_error = true;
-}
-
-void Lox::error(Token token, std::string message)
-{
-   if (token.type == END_OF_FILE) 
-   {
-      report(token.line, " at end", message);
-   } 
-   else 
-   {
-      report(token.line, " at '" + token.lexeme + "'", message);
+      isolate.run(std::make_unique<SourceText>(input));
+      isolate.forget_errors();
    }
 }
 
-void Lox::runtime_error(RuntimeError error)
+void Lox::print_stats(const Isolate& isolate, const Settings& settings, std::ostream& out)
 {
-   std::cerr << error.what() << std::endl << "[line " << error.token.line << "]\n";
-   had_runtime_error = true; 
+   if (settings.gc_stats) {
+      isolate.print_gc_stats(out); }
+   if (settings.alloc_stats) {
+      Pool::print_stats(out); }
 }
\ No newline at end of file
@@ -1,35 +1,74 @@
 #include "headers/LoxClass.h"
 #include "headers/LoxInstance.h"
 
-std::any LoxClass::call(Interpreter& interpeter, std::vector<std::any> arguments)
+// * The superclass table is already flattened, so copying the entries we do not override flattens this one
+LoxClass::LoxClass(std::string name, Ref<LoxClass> superclass, MethodTable own_methods)
+   : name(std::move(name)), superclass(superclass), methods(std::move(own_methods))
 {
-   auto instance = std::make_shared<LoxInstance>(shared_from_this());
-   std::shared_ptr<LoxFunction> initializer = find_method("init");
+   if (superclass != nullptr) {
+      for (const auto& [method_name, method] : superclass->methods) {
+         methods.emplace(method_name, method);
+      }
+   }
+   initializer = find_method("init");
+   track();
+}
+
+void LoxClass::trace(Tracer& tracer)
+{
+   tracer.visit(superclass.get());
+   tracer.visit(initializer.get());
+   for (const auto& [method_name, method] : methods) {
+      tracer.visit(method.get());
+   }
+}
+
+void LoxClass::clear_references()
+{
+   superclass = nullptr;
+   initializer = nullptr;
+   methods.clear();
+}
+
+Value LoxClass::call(Interpreter& interpeter, const std::vector<Value>& arguments)
+{
+   Value instance = Ref<LoxInstance>{new LoxInstance(Ref<LoxClass>(this))};
    if (initializer != nullptr) {
-      initializer->bind(instance)->call(interpeter, arguments);
+      Ref<Environment> frame = initializer->new_frame(interpeter, instance);
+      for (const Value& argument : arguments)
+      {
+         frame->define(argument);
+      }
+      initializer->call(interpeter, std::move(frame));
    }
    return instance;
 }
 
 int LoxClass::arity()
 {
-   std::shared_ptr<LoxFunction> initializer = find_method("init");
    if (initializer == nullptr) {
       return 0;
    }
    return initializer->arity();
 }
 
-std::shared_ptr<LoxFunction> LoxClass::find_method(std::string name)
+LoxFunction* LoxClass::find_method(const std::string& name)
 {
-   if (methods.find(name) != methods.end())
-   {
-      return methods[name];
+   auto elem = methods.find(name);
+   if (elem == methods.end()) {
+      return nullptr;
    }
+   return elem->second.get();
+}
 
-   if (superclass != nullptr) {
-      return superclass->find_method(name);
+LoxFunction* LoxClass::find_method(std::string_view name, PropertyCache& cache)
+{
+   if (const PropertyCache::Entry* entry = cache.find(instance_shape.get())) {
+      return entry->method;
    }
-
-   return nullptr;
+   PropertyCache::Entry miss;
+   miss.shape = instance_shape;
+   miss.method = find_method(std::string(name));
+   cache.add(miss);
+   return miss.method;
 }
\ No newline at end of file
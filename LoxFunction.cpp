@@ -4,30 +4,70 @@
 #include "headers/RuntimeError.h"
 #include "headers/LoxInstance.h"
 
-LoxFunction::LoxFunction(std::shared_ptr<Function> declaration,  std::shared_ptr<Environment> closure, bool is_initializer)
-   :declaration(declaration), closure(closure), is_initializer(is_initializer)
-{ }
+LoxFunction::LoxFunction(Function* declaration,  Ref<Environment> closure, FunctionType type, Value receiver)
+   :declaration(declaration), closure(closure), type(type), receiver(receiver)
+{
+   track();
+}
+
+void LoxFunction::trace(Tracer& tracer)
+{
+   tracer.visit(closure.get());
+   tracer.visit(receiver);
+}
 
-std::any LoxFunction::call(Interpreter& interpeter, std::vector<std::any> arguments) 
+void LoxFunction::clear_references()
 {
-   auto environment = std::make_shared<Environment>(closure); 
-   for (int i = 0; i < static_cast<int>(declaration->params.size()); i++)
+   closure = nullptr;
+   receiver = nullptr;
+}
+
+Value LoxFunction::call(Interpreter& interpeter, const std::vector<Value>& arguments) 
+{
+   Ref<Environment> frame = new_frame(interpeter);
+   for (const Value& argument : arguments)
    {
-      environment->define(declaration->params[i].lexeme, arguments[i]);
+      frame->define(argument);
    }
-   try {
-      interpeter.execute_block(std::vector<std::shared_ptr<Stmt>>{declaration->body}, environment);
-   } catch (LoxReturn return_value) {
-      if (is_initializer) {
-         return closure->get_at(0, "this");
-      }
-      return return_value.value;
+   return call(interpeter, std::move(frame));
+}
+
+Ref<Environment> LoxFunction::new_frame(Interpreter& interpeter)
+{
+   return new_frame(interpeter, receiver);
+}
+
+// * The environment a call runs in, the caller defines the arguments in it as the parameter slots
+// * Methods keep "this" in the first slot, ahead of the parameters
+Ref<Environment> LoxFunction::new_frame(Interpreter& interpeter, const Value& instance)
+{
+   Ref<Environment> frame = interpeter.acquire_environment(closure);
+   if (!instance.is_nil()) {
+      frame->define(instance);
    }
+   return frame;
+}
 
-   if (is_initializer) {
-      return closure->get_at(0, "this");
+Value LoxFunction::call(Interpreter& interpeter, Ref<Environment> frame)
+{
+   if (type == FunctionType::FUNCTION and interpeter.jit.enabled)
+   {
+      Value result;
+      if (interpeter.jit.run(declaration, *frame, result)) {
+         interpeter.release_environment(std::move(frame));
+         return result;
+      }
    }
-   return nullptr;
+
+   Function* caller = interpeter.current_function;
+   interpeter.current_function = declaration;
+   Completion completion = declaration->compiled_body != nullptr
+      ? interpeter.execute_block(declaration->compiled_body->statements, frame)
+      : interpeter.execute_block(declaration->body, frame);
+   interpeter.current_function = caller;
+   Value result = type == FunctionType::INITIALIZER ? frame->get_at(0, 0) : completion.value; // * nil unless the body returned a value
+   interpeter.release_environment(std::move(frame));
+   return result;
 }
 
 int LoxFunction::arity()
@@ -37,12 +77,11 @@ int LoxFunction::arity()
 
 std::string LoxFunction::to_string()
 {
-   return "<fn " + declaration->name.lexeme + ">";
+   return "<fn " + std::string(declaration->name.lexeme) + ">";
 }
 
-std::shared_ptr<LoxFunction> LoxFunction::bind(std::shared_ptr<LoxInstance> instance)
+// * Only needed when a method is used as a value, calls like instance.method() run the method directly
+Ref<LoxFunction> LoxFunction::bind(Value instance)
 {
-   auto environment = std::make_shared<Environment>(closure);
-   environment->define("this", instance);
-   return std::make_shared<LoxFunction>(declaration, environment, is_initializer);
+   return Ref<LoxFunction>{new LoxFunction(declaration, closure, type, instance)};
 }
\ No newline at end of file
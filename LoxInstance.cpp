@@ -2,32 +2,101 @@
 #include "headers/RuntimeError.h"
 #include "headers/LoxFunction.h"
 
-LoxInstance::LoxInstance(std::shared_ptr<LoxClass> lox_class)
-   : lox_class(lox_class)
-{}
+LoxInstance::LoxInstance(Ref<LoxClass> lox_class)
+   : lox_class(lox_class), shape(lox_class->instance_shape), fields(SpareVectors<Value>::take())
+{
+   track();
+}
+
+LoxInstance::~LoxInstance()
+{
+   SpareVectors<Value>::give_back(fields);
+}
+
+void LoxInstance::trace(Tracer& tracer)
+{
+   tracer.visit(lox_class.get());
+   for (const Value& field : fields) {
+      tracer.visit(field);
+   }
+}
+
+void LoxInstance::clear_references()
+{
+   lox_class = nullptr;
+   fields.clear();
+}
 
 std::string LoxInstance::to_string() 
 { 
    return lox_class-> name + " instance"; 
 }
 
-std::any LoxInstance::get(Token name)
+Value LoxInstance::get(const Token& name, PropertyCache& cache)
 {
-   if (fields.find(name.lexeme) != fields.end()) {
-      return fields[name.lexeme];
+   PropertyCache::Entry miss;
+   const PropertyCache::Entry& entry = lookup(name.lexeme, cache, miss);
+   if (entry.slot >= 0) {
+      return fields[entry.slot];
    }
 
-   std::shared_ptr<LoxFunction> method = lox_class->find_method(name.lexeme);
-   if (method != nullptr) { 
-      return method->bind( shared_from_this() );
+   if (entry.method != nullptr) { 
+      return entry.method->bind( Value(Ref<LoxInstance>(this)) );
    }
 
-   throw RuntimeError(name, "Undefined property '" + name.lexeme + "'.");
+   throw RuntimeError(name, "Undefined property '" + std::string(name.lexeme) + "'.");
 }
 
+// * The method a call like instance.name() runs, unless a field with the same name shadows it
+LoxFunction* LoxInstance::find_method(std::string_view name, PropertyCache& cache)
+{
+   PropertyCache::Entry miss;
+   const PropertyCache::Entry& entry = lookup(name, cache, miss);
+   if (entry.slot >= 0) {
+      return nullptr;
+   }
+   return entry.method;
+}
 
-void LoxInstance::set(Token name, std::any value)
+void LoxInstance::set(const Token& name, Value value, PropertyCache& cache)
 {
-   fields[name.lexeme] = value;
+   PropertyCache::Entry miss;
+   const PropertyCache::Entry* entry = cache.find(shape.get());
+   if (entry == nullptr) 
+   {
+      std::string key{name.lexeme};
+      miss.shape = shape;
+      miss.slot = shape->slot_of(key);
+      if (miss.slot < 0) {
+         miss.transition = shape->with_field(key);
+         miss.slot = fields.size();
+      }
+      cache.add(miss);
+      entry = &miss;
+   }
+
+   if (entry->transition != nullptr) {
+      shape = entry->transition;
+      fields.push_back(std::move(value));
+   }
+   else {
+      fields[entry->slot] = std::move(value);
+   }
 }
 
+// * The cache entry for this instance's shape, the name is only looked up when the cache misses
+const PropertyCache::Entry& LoxInstance::lookup(std::string_view name, PropertyCache& cache, PropertyCache::Entry& miss)
+{
+   if (const PropertyCache::Entry* entry = cache.find(shape.get())) {
+      return *entry;
+   }
+
+   std::string key{name};
+   miss.shape = shape;
+   miss.slot = shape->slot_of(key);
+   if (miss.slot < 0) {
+      miss.method = lox_class->find_method(key);
+   }
+   cache.add(miss);
+   return miss;
+}
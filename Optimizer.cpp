@@ -0,0 +1,434 @@
+#include "headers/Optimizer.h"
+
+Optimizer::Optimizer(Arena& arena)
+   : arena(arena)
+{}
+
+std::vector<Stmt*> Optimizer::optimize(const std::vector<Stmt*>& statements)
+{
+   std::vector<Stmt*> optimized;
+   optimized.reserve(statements.size());
+   for (Stmt* stmt : statements)
+   {
+      if (Stmt* result = optimize(stmt)) {
+         optimized.push_back(result);
+      }
+   }
+   return optimized;
+}
+
+Expr* Optimizer::optimize(Expr* expr)
+{
+   expr->accept(*this);
+   return expr_result;
+}
+
+Stmt* Optimizer::optimize(Stmt* stmt)
+{
+   stmt->accept(*this);
+   return stmt_result;
+}
+
+// * The body of an if or while has to stay a statement, an empty block stands in for one that was removed
+Stmt* Optimizer::optimize_branch(Stmt* stmt)
+{
+   if (Stmt* result = optimize(stmt)) {
+      return result;
+   }
+   return arena.make<Block>(std::vector<Stmt*>{});
+}
+
+// * Only the truthiness of a condition matters, so !!x can become x whatever x is
+Expr* Optimizer::optimize_condition(Expr* expr)
+{
+   Expr* condition = optimize(expr);
+   if (auto outer = dynamic_cast<Unary*>(condition); outer != nullptr and outer->op.type == BANG)
+   {
+      if (auto inner = dynamic_cast<Unary*>(outer->right); inner != nullptr and inner->op.type == BANG) {
+         return inner->right;
+      }
+   }
+   return condition;
+}
+
+const Literal* Optimizer::as_literal(Expr* expr)
+{
+   return dynamic_cast<const Literal*>(expr);
+}
+
+// * Expressions that always produce a bool, when they produce anything at all
+bool Optimizer::is_boolean(Expr* expr)
+{
+   if (const Literal* literal = as_literal(expr)) {
+      return literal->value.is_bool();
+   }
+   if (auto unary = dynamic_cast<Unary*>(expr)) {
+      return unary->op.type == BANG;
+   }
+   if (auto binary = dynamic_cast<Binary*>(expr))
+   {
+      switch (binary->op.type)
+      {
+         case GREATER: case GREATER_EQUAL: case LESS: case LESS_EQUAL: case BANG_EQUAL: case EQUAL_EQUAL:
+            return true;
+         default:
+            return false;
+      }
+   }
+   return false;
+}
+
+// * Expressions that always produce a number, when they produce anything at all. Plus is not one of them, it also concatenates
+bool Optimizer::is_number(Expr* expr)
+{
+   if (const Literal* literal = as_literal(expr)) {
+      return literal->value.is_number();
+   }
+   if (auto unary = dynamic_cast<Unary*>(expr)) {
+      return unary->op.type == MINUS;
+   }
+   if (auto binary = dynamic_cast<Binary*>(expr))
+   {
+      switch (binary->op.type)
+      {
+         case MINUS: case SLASH: case STAR:
+            return true;
+         default:
+            return false;
+      }
+   }
+   return false;
+}
+
+Value Optimizer::visit_BinaryExpr(Binary* expr)
+{
+   Expr* left  = optimize(expr->left);
+   Expr* right = optimize(expr->right);
+
+   const Literal* left_literal  = as_literal(left);
+   const Literal* right_literal = as_literal(right);
+   if (left_literal != nullptr and right_literal != nullptr)
+   {
+      if (Expr* folded = fold(expr, left_literal->value, right_literal->value)) {
+         expr_result = folded;
+         return nullptr;
+      }
+   }
+
+   if (left != expr->left or right != expr->right) {
+      expr_result = arena.make<Binary>(left, expr->op, right);
+   }
+   else {
+      expr_result = expr;
+   }
+   return nullptr;
+}
+
+// * Returns nullptr when the operation would be a runtime error, the error is then left for the program to hit
+Expr* Optimizer::fold(Binary* expr, const Value& left, const Value& right)
+{
+   bool numbers = left.is_number() and right.is_number();
+
+   switch (expr->op.type)
+   {
+      case BANG_EQUAL:  return arena.make<Literal>(expr->op, !left.equals(right));
+      case EQUAL_EQUAL: return arena.make<Literal>(expr->op, left.equals(right));
+      case PLUS:
+         if (numbers) {
+            return arena.make<Literal>(expr->op, left.as_number() + right.as_number());
+         }
+         if (left.is_string() and right.is_string()) {
+            return arena.make<Literal>(expr->op, left.as_string() + right.as_string());
+         }
+         return nullptr;
+      default:
+         break;
+   }
+
+   if (!numbers) { 
+      return nullptr; }
+
+   double a = left.as_number();
+   double b = right.as_number();
+   switch (expr->op.type)
+   {
+      case GREATER:       return arena.make<Literal>(expr->op, a >  b);
+      case GREATER_EQUAL: return arena.make<Literal>(expr->op, a >= b);
+      case LESS:          return arena.make<Literal>(expr->op, a <  b);
+      case LESS_EQUAL:    return arena.make<Literal>(expr->op, a <= b);
+      case MINUS:         return arena.make<Literal>(expr->op, a -  b);
+      case SLASH:         return arena.make<Literal>(expr->op, a /  b);
+      case STAR:          return arena.make<Literal>(expr->op, a *  b);
+      default:            return nullptr;
+   }
+}
+
+Value Optimizer::visit_GroupExpr(Group* expr)
+{
+   expr_result = optimize(expr->expr_in);
+   return nullptr;
+}
+
+Value Optimizer::visit_LiteralExpr(Literal* expr)
+{
+   expr_result = expr;
+   return nullptr;
+}
+
+Value Optimizer::visit_UnaryExpr(Unary* expr)
+{
+   Expr* right = optimize(expr->right);
+
+   if (const Literal* literal = as_literal(right))
+   {
+      if (expr->op.type == BANG) {
+         expr_result = arena.make<Literal>(expr->op, !literal->value.is_truthy());
+         return nullptr;
+      }
+      if (expr->op.type == MINUS and literal->value.is_number()) {
+         expr_result = arena.make<Literal>(expr->op, -literal->value.as_number());
+         return nullptr;
+      }
+   }
+
+   // * !!x is x when x is already a bool and --x is x when x is already a number, otherwise the operators convert or throw
+   if (auto inner = dynamic_cast<Unary*>(right); inner != nullptr and inner->op.type == expr->op.type)
+   {
+      if ((expr->op.type == BANG and is_boolean(inner->right)) or (expr->op.type == MINUS and is_number(inner->right))) {
+         expr_result = inner->right;
+         return nullptr;
+      }
+   }
+
+   if (right != expr->right) {
+      expr_result = arena.make<Unary>(expr->op, right);
+   }
+   else {
+      expr_result = expr;
+   }
+   return nullptr;
+}
+
+Value Optimizer::visit_VariableExpr(Variable* expr)
+{
+   expr_result = expr;
+   return nullptr;
+}
+
+Value Optimizer::visit_AssignExpr(Assign* expr)
+{
+   Expr* value = optimize(expr->value);
+
+   if (value != expr->value) 
+   {
+      Assign* assign = arena.make<Assign>(expr->name, value);
+      assign->resolution = expr->resolution;
+      expr_result = assign;
+   }
+   else {
+      expr_result = expr;
+   }
+   return nullptr;
+}
+
+// * A literal on the left decides which operand is the result
+Value Optimizer::visit_LogicalExpr(Logical* expr)
+{
+   Expr* left  = optimize(expr->left);
+   Expr* right = optimize(expr->right);
+
+   if (const Literal* literal = as_literal(left))
+   {
+      bool short_circuits = (expr->op.type == TokenType::OR) == literal->value.is_truthy();
+      expr_result = short_circuits ? left : right;
+      return nullptr;
+   }
+
+   if (left != expr->left or right != expr->right) {
+      expr_result = arena.make<Logical>(left, expr->op, right);
+   }
+   else {
+      expr_result = expr;
+   }
+   return nullptr;
+}
+
+Value Optimizer::visit_CallExpr(Call* expr)
+{
+   Expr* callee = optimize(expr->calle);
+   bool changed = callee != expr->calle;
+
+   std::vector<Expr*> arguments;
+   arguments.reserve(expr->arguements.size());
+   for (Expr* argument : expr->arguements)
+   {
+      arguments.push_back(optimize(argument));
+      changed = changed or arguments.back() != argument;
+   }
+
+   if (changed) {
+      expr_result = arena.make<Call>(callee, expr->paren, std::move(arguments));
+   }
+   else {
+      expr_result = expr;
+   }
+   return nullptr;
+}
+
+Value Optimizer::visit_GetExpr(Get* expr)
+{
+   Expr* object = optimize(expr->object);
+
+   if (object != expr->object) {
+      expr_result = arena.make<Get>(object, expr->name);
+   }
+   else {
+      expr_result = expr;
+   }
+   return nullptr;
+}
+
+Value Optimizer::visit_SetExpr(Set* expr)
+{
+   Expr* object = optimize(expr->object);
+   Expr* value  = optimize(expr->value);
+
+   if (object != expr->object or value != expr->value) {
+      expr_result = arena.make<Set>(object, expr->name, value);
+   }
+   else {
+      expr_result = expr;
+   }
+   return nullptr;
+}
+
+Value Optimizer::visit_ThisExpr(This* expr)
+{
+   expr_result = expr;
+   return nullptr;
+}
+
+Value Optimizer::visit_SuperExpr(Super* expr)
+{
+   expr_result = expr;
+   return nullptr;
+}
+
+Completion Optimizer::visit_ExpressionStmt(Expression* stmt)
+{
+   Expr* expression = optimize(stmt->expression);
+   stmt_result = expression != stmt->expression ? arena.make<Expression>(expression) : stmt;
+   return {};
+}
+
+Completion Optimizer::visit_PrintStmt(Print* stmt)
+{
+   Expr* expression = optimize(stmt->expression);
+   stmt_result = expression != stmt->expression ? arena.make<Print>(expression) : stmt;
+   return {};
+}
+
+Completion Optimizer::visit_VarStmt(Var* stmt)
+{
+   if (stmt->initializer == nullptr) {
+      stmt_result = stmt;
+      return {};
+   }
+
+   Expr* initializer = optimize(stmt->initializer);
+   stmt_result = initializer != stmt->initializer ? arena.make<Var>(stmt->name, initializer) : stmt;
+   return {};
+}
+
+// * The block is kept even when it ends up empty, it is a scope the Resolver counted
+Completion Optimizer::visit_BlockStmt(Block* stmt)
+{
+   std::vector<Stmt*> statements = optimize(stmt->statements);
+   stmt_result = statements != stmt->statements ? arena.make<Block>(std::move(statements)) : stmt;
+   return {};
+}
+
+Completion Optimizer::visit_IfStmt(If* stmt)
+{
+   Expr* condition = optimize_condition(stmt->condition);
+
+   if (const Literal* literal = as_literal(condition))
+   {
+      if (literal->value.is_truthy()) {
+         stmt_result = optimize(stmt->then_branch);
+      }
+      else {
+         stmt_result = stmt->else_branch != nullptr ? optimize(stmt->else_branch) : nullptr;
+      }
+      return {};
+   }
+
+   Stmt* then_branch = optimize_branch(stmt->then_branch);
+   Stmt* else_branch = stmt->else_branch != nullptr ? optimize(stmt->else_branch) : nullptr;
+
+   if (condition != stmt->condition or then_branch != stmt->then_branch or else_branch != stmt->else_branch) {
+      stmt_result = arena.make<If>(stmt->keyword, condition, then_branch, else_branch);
+   }
+   else {
+      stmt_result = stmt;
+   }
+   return {};
+}
+
+Completion Optimizer::visit_WhileStmt(While* stmt)
+{
+   Expr* condition = optimize_condition(stmt->condition);
+
+   if (const Literal* literal = as_literal(condition); literal != nullptr and !literal->value.is_truthy()) {
+      stmt_result = nullptr;
+      return {};
+   }
+
+   Stmt* body = optimize_branch(stmt->body);
+   if (condition != stmt->condition or body != stmt->body) {
+      stmt_result = arena.make<While>(stmt->keyword, condition, body);
+   }
+   else {
+      stmt_result = stmt;
+   }
+   return {};
+}
+
+Function* Optimizer::optimize_function(Function* function)
+{
+   std::vector<Stmt*> body = optimize(function->body);
+   if (body == function->body) {
+      return function;
+   }
+   return arena.make<Function>(function->name, function->params, std::move(body));
+}
+
+Completion Optimizer::visit_FunctionStmt(Function* stmt)
+{
+   stmt_result = optimize_function(stmt);
+   return {};
+}
+
+Completion Optimizer::visit_ReturnStmt(Return* stmt)
+{
+   if (stmt->value == nullptr) {
+      stmt_result = stmt;
+      return {};
+   }
+
+   Expr* value = optimize(stmt->value);
+   stmt_result = value != stmt->value ? arena.make<Return>(stmt->keyword, value) : stmt;
+   return {};
+}
+
+Completion Optimizer::visit_ClassStmt(Class* stmt)
+{
+   std::vector<Function*> methods;
+   methods.reserve(stmt->methods.size());
+   for (Function* method : stmt->methods) {
+      methods.push_back(optimize_function(method));
+   }
+
+   stmt_result = methods != stmt->methods ? arena.make<Class>(stmt->name, stmt->superclass, std::move(methods)) : stmt;
+   return {};
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "headers/ParallelParser.h"
+#include "headers/Parser.h"
+#include "headers/DeclarationBoundary.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+ParallelParser::ParallelParser(const std::vector<Token>& tokens, Arena& arena, ErrorReporter& errors)
+   : tokens(tokens), arena(arena), errors(errors)
+{}
+
+std::vector<Stmt*> ParallelParser::parse()
+{
+   unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+   int token_count = tokens.size() - 1; // * Without the END_OF_FILE
+   std::vector<int> starts = cut(std::max(MIN_PART_TOKENS, token_count / int(threads * PARTS_PER_THREAD) + 1));
+   if (starts.size() < 2) {
+      return Parser{tokens, arena, errors}.parse();
+   }
+
+   std::vector<Part> parts(starts.size());
+   for (std::size_t i = 0; i < parts.size(); ++i) {
+      parts[i].begin = starts[i];
+      parts[i].end = i + 1 < starts.size() ? starts[i + 1] : token_count;
+   }
+
+   std::atomic<std::size_t> next_part{0};
+   auto work = [&]() {
+      for (std::size_t i = next_part++; i < parts.size(); i = next_part++) {
+         parse_part(tokens, parts[i]);
+      }
+   };
+   std::vector<std::thread> workers;
+   for (unsigned i = 1; i < std::min<std::size_t>(threads, parts.size()); ++i) {
+      workers.emplace_back(work);
+   }
+   work();
+   for (std::thread& worker : workers) {
+      worker.join();
+   }
+
+   if (std::any_of(parts.begin(), parts.end(), [](const Part& part) { return part.failed; })) {
+      return Parser{tokens, arena, errors}.parse(); // * The parts' arenas go away with them
+   }
+
+   std::vector<Stmt*> statements;
+   for (Part& part : parts) {
+      statements.insert(statements.end(), part.statements.begin(), part.statements.end());
+      arena.absorb(part.arena);
+   }
+   return statements;
+}
+
+// * Where each part starts: at the first declaration after part_tokens more tokens
+std::vector<int> ParallelParser::cut(int part_tokens)
+{
+   std::vector<int> starts{0};
+   DeclarationBoundary boundary;
+   int token_count = tokens.size() - 1;
+   for (int i = 0; i < token_count; ++i) {
+      if (boundary.starts_declaration(tokens[i]) and i - starts.back() >= part_tokens) {
+         starts.push_back(i);
+      }
+   }
+   return starts;
+}
+
+void ParallelParser::parse_part(const std::vector<Token>& tokens, Part& part)
+{
+   Parser parser{tokens, part.arena, part.begin, part.end};
+   part.statements = parser.parse();
+   part.failed = parser.has_error();
+}
\ No newline at end of file
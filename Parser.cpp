@@ -1,16 +1,20 @@
 #include "headers/Parser.h"
-#include "headers/Lox.h"
 #include <cassert>
 #include <iostream>
 
-Parser::Parser(std::vector<Token>& tokens)
-   :tokens(tokens)
+Parser::Parser(const std::vector<Token>& tokens, Arena& arena, ErrorReporter& errors)
+   :tokens(tokens), arena(arena), end(tokens.size()), errors(&errors)
 { 
 }
 
-std::vector<std::shared_ptr<Stmt>> Parser::parse()
+Parser::Parser(const std::vector<Token>& tokens, Arena& arena, int begin, int end)
+   :tokens(tokens), arena(arena), current(begin), end(end), errors(nullptr)
 {
-   std::vector<std::shared_ptr<Stmt>> statements;
+}
+
+std::vector<Stmt*> Parser::parse()
+{
+   std::vector<Stmt*> statements;
    while (!is_at_end()) {
       statements.push_back( declaration() ); // ! I want to replace this with a function like recursive_decent() 
    }
@@ -18,7 +22,7 @@ std::vector<std::shared_ptr<Stmt>> Parser::parse()
    return statements; 
 }
 
-std::shared_ptr<Stmt> Parser::declaration()
+Stmt* Parser::declaration()
 {
    try 
    {
@@ -33,62 +37,62 @@ std::shared_ptr<Stmt> Parser::declaration()
    }
 }
 
-std::shared_ptr<Stmt> Parser::var_declaration()
+Stmt* Parser::var_declaration()
 {
-   Token name = consume(IDENTIFIER, "Expect variable name.");
+   const Token& name = consume(IDENTIFIER, "Expect variable name.");
 
-   std::shared_ptr<Expr> initializer = nullptr;
+   Expr* initializer = nullptr;
    if (match(EQUAL)) {
       initializer = expression();
    }
    consume(SEMICOLON, "Expect ';' after variable declaration.");
-   return std::make_shared<Var>(Var(name, initializer));
+   return arena.make<Var>(name, initializer);
 }
 
-std::shared_ptr<Stmt> Parser::class_declaration()
+Stmt* Parser::class_declaration()
 {
-   Token name = consume(IDENTIFIER, "Expect class name.");
+   const Token& name = consume(IDENTIFIER, "Expect class name.");
 
-   std::shared_ptr<Variable> superclass = nullptr;
+   Variable* superclass = nullptr;
    if (match(LESS)) {
       consume(IDENTIFIER, "Expect superclass name.");
-      superclass = std::make_shared<Variable>(previous());  
+      superclass = arena.make<Variable>(previous());  
    }
    consume(LEFT_BRACE, "Expect '{' before class body.");
-   std::vector<std::shared_ptr<Function>> methods;
+   std::vector<Function*> methods;
    while( !check(RIGHT_BRACE) and !is_at_end()) {
       methods.push_back( function("method") );
    }
 
    consume(RIGHT_BRACE, "Expect '}' after class body.");
 
-   return std::make_shared<Class>(name, superclass, methods);
+   return arena.make<Class>(name, superclass, methods);
 }
 
-std::shared_ptr<Expr> Parser::expression()
+Expr* Parser::expression()
 {
    return assignment();
 }
  
-std::shared_ptr<Expr> Parser::assignment()
+Expr* Parser::assignment()
 {
-   std::shared_ptr<Expr> expr = or_expression();
+   Expr* expr = or_expression();
 
    if (match(EQUAL)) 
    {
-      Token equals = previous();
-      std::shared_ptr<Expr> value = assignment();  // ** <- A recursive call
+      const Token& equals = previous();
+      Expr* value = assignment();  // ** <- A recursive call
 
       // * https://stackoverflow.com/questions/19501838/get-derived-type-via-base-class-virtual-function
       // ** Check if expr is of type Variable or Get
-      if (Variable* e = dynamic_cast<Variable*>(expr.get())) 
+      if (Variable* e = dynamic_cast<Variable*>(expr)) 
       {
-         Token name = e->name;
-         return std::make_shared<Assign>(name, value);
+         const Token& name = e->name;
+         return arena.make<Assign>(name, value);
       }
-      else if (Get* get = dynamic_cast<Get*>(expr.get())) 
+      else if (Get* get = dynamic_cast<Get*>(expr)) 
       {
-         return std::make_shared<Set>(get->object, get->name, value);
+         return arena.make<Set>(get->object, get->name, value);
       }
       error(equals, "Invalid assignment target.");
    }
@@ -96,105 +100,105 @@ std::shared_ptr<Expr> Parser::assignment()
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::or_expression()
+Expr* Parser::or_expression()
 {
-   std::shared_ptr<Expr> expr = and_expression();
+   Expr* expr = and_expression();
 
    while (match(OR))
    {
-      Token op = previous();
-      std::shared_ptr<Expr> right = equality();
-      expr = std::make_shared<Logical>(expr, op, right);
+      const Token& op = previous();
+      Expr* right = equality();
+      expr = arena.make<Logical>(expr, op, right);
    }
    
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::and_expression()
+Expr* Parser::and_expression()
 {
-   std::shared_ptr<Expr> expr = equality();
+   Expr* expr = equality();
 
    while (match(AND))
    {
-      Token op = previous();
-      std::shared_ptr<Expr> right = equality();
-      expr = std::make_shared<Logical>(expr, op, right);
+      const Token& op = previous();
+      Expr* right = equality();
+      expr = arena.make<Logical>(expr, op, right);
    }
    
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::equality()
+Expr* Parser::equality()
 {
-   std::shared_ptr<Expr> expr = comparison();
+   Expr* expr = comparison();
 
    while ( match( BANG_EQUAL, EQUAL_EQUAL ))
    {
-      Token op = previous();
-      std::shared_ptr<Expr> right = comparison();
-      expr = std::make_shared<Binary>(expr, op, right);
+      const Token& op = previous();
+      Expr* right = comparison();
+      expr = arena.make<Binary>(expr, op, right);
    }
 
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::comparison()
+Expr* Parser::comparison()
 {
-   std::shared_ptr<Expr> expr = term();
+   Expr* expr = term();
 
    while ( match(GREATER, GREATER_EQUAL, LESS, LESS_EQUAL) )
    {
-      Token op = previous();
-      std::shared_ptr<Expr> right = term();
-      expr = std::make_shared<Binary>(expr, op, right);
+      const Token& op = previous();
+      Expr* right = term();
+      expr = arena.make<Binary>(expr, op, right);
    }
 
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::term()
+Expr* Parser::term()
 {
-   std::shared_ptr<Expr> expr = factor();
+   Expr* expr = factor();
 
    while (match(MINUS, PLUS)) 
    {
-      Token op = previous();
-      std::shared_ptr<Expr> right = factor();
-      expr = std::make_shared<Binary>(expr, op, right);
+      const Token& op = previous();
+      Expr* right = factor();
+      expr = arena.make<Binary>(expr, op, right);
    }
 
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::factor()
+Expr* Parser::factor()
 {
-   std::shared_ptr<Expr> expr = unary();
+   Expr* expr = unary();
 
    while (match(SLASH, STAR)) 
    {
-      Token op = previous();
-      std::shared_ptr<Expr> right = unary();
-      expr = std::make_shared<Binary>(expr, op, right);
+      const Token& op = previous();
+      Expr* right = unary();
+      expr = arena.make<Binary>(expr, op, right);
    }
 
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::unary()
+Expr* Parser::unary()
 {
    if (match(BANG, MINUS)) 
    {
-      Token op = previous();
-      std::shared_ptr<Expr> right = unary();
-      return std::make_shared<Unary>(op, right);
+      const Token& op = previous();
+      Expr* right = unary();
+      return arena.make<Unary>(op, right);
    }
 
    return call();
 }
 
-std::shared_ptr<Expr> Parser::call()
+Expr* Parser::call()
 {
-   std::shared_ptr<Expr> expr = primary();
+   Expr* expr = primary();
 
    while (true) 
    {
@@ -204,8 +208,8 @@ std::shared_ptr<Expr> Parser::call()
       } 
       else if (match(DOT)) 
       {
-         Token name = consume(IDENTIFIER, "Expect property name after '.'.");
-         expr = std::make_shared<Get>(expr, name);
+         const Token& name = consume(IDENTIFIER, "Expect property name after '.'.");
+         expr = arena.make<Get>(expr, name);
       }
       else { break; }
    }
@@ -213,9 +217,9 @@ std::shared_ptr<Expr> Parser::call()
    return expr;
 }
 
-std::shared_ptr<Expr> Parser::finish_call(std::shared_ptr<Expr> callee)
+Expr* Parser::finish_call(Expr* callee)
 {
-   std::vector<std::shared_ptr<Expr>> arguments;
+   std::vector<Expr*> arguments;
 
    if (!check(RIGHT_PAREN))
    {
@@ -226,49 +230,52 @@ std::shared_ptr<Expr> Parser::finish_call(std::shared_ptr<Expr> callee)
       while ( match(COMMA) );
    }
 
-   Token paren = consume(RIGHT_PAREN, "Expect ')' after arguements.");
+   const Token& paren = consume(RIGHT_PAREN, "Expect ')' after arguements.");
 
-   return std::make_shared<Call>(callee, paren, arguments);
+   return arena.make<Call>(callee, paren, arguments);
 }
 
 // ** this is the last stop of recursion
-std::shared_ptr<Expr> Parser::primary()
+Expr* Parser::primary()
 {
-   if (match(LOX_FALSE)) {return std::make_shared<Literal>(false);}
-   if (match(LOX_TRUE)) {return std::make_shared<Literal>(true);}
-   if (match(NIL)) {return std::make_shared<Literal>(nullptr);}
+   if (match(LOX_FALSE)) {return arena.make<Literal>(previous(), false);}
+   if (match(LOX_TRUE)) {return arena.make<Literal>(previous(), true);}
+   if (match(NIL)) {return arena.make<Literal>(previous(), nullptr);}
 
-   if (match(NUMBER, STRING)) {
-      return std::make_shared<Literal>(previous().literal);
+   if (match(NUMBER)) {
+      return arena.make<Literal>(previous(), previous().number);
+   }
+   if (match(STRING)) {
+      return arena.make<Literal>(previous(), std::string(previous().string_value()));
    }
    if (match(SUPER)) {
-      Token keyword = previous();
+      const Token& keyword = previous();
       consume(DOT, "Expect '.' after 'super'.");
-      Token method = consume(IDENTIFIER, "Expect superclass method name.");
-      return std::make_shared<Super>(keyword, method);
+      const Token& method = consume(IDENTIFIER, "Expect superclass method name.");
+      return arena.make<Super>(keyword, method);
    }
 
-   if (match(THIS)) {return std::make_shared<This>(previous());}
+   if (match(THIS)) {return arena.make<This>(previous());}
 
    if (match(IDENTIFIER)) {
-      return std::make_shared<Variable>(previous());
+      return arena.make<Variable>(previous());
    }
 
    if (match(LEFT_PAREN)) {   
-      std::shared_ptr<Expr> expr = expression();
+      Expr* expr = expression();
       consume(RIGHT_PAREN, "Expect ')' after expression.");
-      return std::make_shared<Group>(expr);
+      return arena.make<Group>(expr);
    }
     
    throw error(peek(), "Expect expression."); 
 }
 
-std::shared_ptr<Stmt> Parser::statement()
+Stmt* Parser::statement()
 {
    if (match(PRINT)){ return print_statement(); }
    if (match(RETURN)){ return return_statement(); }
    if (match(WHILE)){ return while_statement(); }
-   if (match(LEFT_BRACE)) { return std::make_shared<Block>(block()); } // -> Initilize a shared pointer to a block object with a vector of statements that is returned by the block() function
+   if (match(LEFT_BRACE)) { return arena.make<Block>(block()); } // -> Allocate a block object holding the vector of statements that is returned by the block() function
    if (match(FOR)) { return for_statement(); }
    if (match(IF)) { return if_statement(); }
    return expression_statement();
@@ -283,11 +290,12 @@ std::shared_ptr<Stmt> Parser::statement()
    
    The for statement gets converted into a while statement
 */
-std::shared_ptr<Stmt> Parser::for_statement()
+Stmt* Parser::for_statement()
 {
+   const Token& keyword = previous();
    consume(LEFT_PAREN, "Expect '(' after 'for'.");
 
-   std::shared_ptr<Stmt> initializer;
+   Stmt* initializer;
    if (match(SEMICOLON)) 
    {
       initializer = nullptr;
@@ -301,112 +309,114 @@ std::shared_ptr<Stmt> Parser::for_statement()
       initializer = expression_statement();
    }
 
-   std::shared_ptr<Expr> condition = nullptr;
+   Expr* condition = nullptr;
    if ( !check(SEMICOLON) ) 
    {
       condition = expression();
    }
    consume(SEMICOLON, "Expect ';' after loop condition.");
 
-   std::shared_ptr<Expr> increment = nullptr;
+   Expr* increment = nullptr;
    if (!check(RIGHT_PAREN)) 
    {
       increment = expression();
    }
    consume(RIGHT_PAREN, "Expect ')' after for clauses.");
 
-   std::shared_ptr<Stmt> body = statement();
+   Stmt* body = statement();
 
    if (increment != nullptr)
    {
-      body = std::make_shared<Block>( std::vector<std::shared_ptr<Stmt>> { body, std::make_shared<Expression>(increment) } );
+      body = arena.make<Block>( std::vector<Stmt*> { body, arena.make<Expression>(increment) } );
    }
 
-   if (condition == nullptr) { condition = std::make_shared<Literal>(true); }
-   body = std::make_shared<While>(condition, body);
+   if (condition == nullptr) { condition = arena.make<Literal>(keyword, true); }
+   body = arena.make<While>(keyword, condition, body);
 
    if (initializer != nullptr) {
-      body = std::make_shared<Block>(std::vector<std::shared_ptr<Stmt>> {initializer, body} );
+      body = arena.make<Block>(std::vector<Stmt*> {initializer, body} );
    }
 
    return body;
 }
 
-std::shared_ptr<Stmt> Parser::if_statement()
+Stmt* Parser::if_statement()
 {
+   const Token& keyword = previous();
    consume(LEFT_PAREN, "Expect '(' after 'if'.");
-   std::shared_ptr<Expr> condition = expression();
+   Expr* condition = expression();
    consume(RIGHT_PAREN, "Expect ')' after 'if condition'.");
 
-   std::shared_ptr<Stmt> then_branch = statement();
-   std::shared_ptr<Stmt> else_branch = nullptr;
+   Stmt* then_branch = statement();
+   Stmt* else_branch = nullptr;
    if (match(ELSE)) {
       else_branch = statement();
    }
    
-   return std::make_shared<If>(condition, then_branch, else_branch);
+   return arena.make<If>(keyword, condition, then_branch, else_branch);
 }
 
-std::shared_ptr<Stmt> Parser::while_statement()
+Stmt* Parser::while_statement()
 {
+   const Token& keyword = previous();
    consume(LEFT_PAREN, "Expect '(' after 'while'.");
-   std::shared_ptr<Expr> condition = expression();
+   Expr* condition = expression();
    consume(RIGHT_PAREN, "Expect ')' after condition.");
-   std::shared_ptr<Stmt> body = statement();
+   Stmt* body = statement();
 
-   return std::make_shared<While>(condition, body);
+   return arena.make<While>(keyword, condition, body);
 }
 
-std::shared_ptr<Stmt> Parser::print_statement()
+Stmt* Parser::print_statement()
 {
-   std::shared_ptr<Expr> value = expression();
+   Expr* value = expression();
    consume(SEMICOLON, "Expect ';' after value.");
-   return std::make_shared<Print>(value);
+   return arena.make<Print>(value);
 }
 
-std::shared_ptr<Stmt> Parser::return_statement()
+Stmt* Parser::return_statement()
 {
-   Token keyword = previous();
-   std::shared_ptr<Expr> value = nullptr;
+   const Token& keyword = previous();
+   Expr* value = nullptr;
    if (!check(SEMICOLON)) {
       value = expression();
    }
 
    consume(SEMICOLON, "Expect ';' after return value.");
-   return std::make_shared<Return>(keyword, value);
+   return arena.make<Return>(keyword, value);
 }
 
-std::shared_ptr<Stmt> Parser::expression_statement()
+Stmt* Parser::expression_statement()
 {
-   std::shared_ptr<Expr> expr = expression();
+   Expr* expr = expression();
    consume(SEMICOLON, "Expect ';' after expression.");
-   return std::make_shared<Expression>(expr);
+   return arena.make<Expression>(expr);
 }
 
-std::shared_ptr<Function> Parser::function(std::string kind)
+Function* Parser::function(std::string kind)
 {
-   Token name = consume(IDENTIFIER,  "Expect " + kind + " name.");
+   const Token& name = consume(IDENTIFIER,  "Expect " + kind + " name.");
    consume(LEFT_PAREN, "Expect '(' after " + kind + " name.");
-   std::vector<Token> parameters;
+   std::vector<const Token*> parameters;
    if (!check(RIGHT_PAREN))
    {
       do {
          if (parameters.size() >= 255) {
             error(peek(), "Can't have more than 255 parameters.");
          }
-         parameters.push_back( consume(IDENTIFIER, "Expect parameter name.") );
+         parameters.push_back( &consume(IDENTIFIER, "Expect parameter name.") );
       } while (match(COMMA));
    }
    consume(RIGHT_PAREN, "Expect ')' after parameters.");
 
    consume(LEFT_BRACE, "Expect '{' before " + kind + " body.");
-   std::vector<std::shared_ptr<Stmt>> body = block();
-   return std::make_shared<Function>(name, parameters, body);
+   std::vector<Stmt*> body = block();
+   return arena.make<Function>(name, parameters, body);
 }
 
-std::vector<std::shared_ptr<Stmt>> Parser::block()
+std::vector<Stmt*> Parser::block()
 {
-   std::vector<std::shared_ptr<Stmt>> statements;
+   std::vector<Stmt*> statements;
 
    while( !check(RIGHT_BRACE) and !is_at_end() )
    {
@@ -441,7 +451,7 @@ bool Parser::check(TokenType type)
    return peek().type == type;
 }
 
-Token Parser::advance()
+const Token& Parser::advance()
 {
    if (not is_at_end()) { current++; }
    return previous();
@@ -449,29 +459,31 @@ Token Parser::advance()
 
 bool Parser::is_at_end()
 {
-   return peek().type == END_OF_FILE;
+   return current >= end or peek().type == END_OF_FILE;
 }
 
-Token Parser::peek()
+const Token& Parser::peek()
 {
    return tokens.at(current);
 }
 
-Token Parser::previous()
+const Token& Parser::previous()
 {
    return tokens.at(current - 1);
 }
 
-Token Parser::consume(TokenType type, std::string message)
+const Token& Parser::consume(TokenType type, std::string message)
 {
    if (check(type)) { return advance(); }
 
    throw error(peek(), message);
 }
 
-ParseError Parser::error(Token token, std::string message)
+ParseError Parser::error(const Token& token, std::string message)
 {
-   Lox::error(token, message);
+   failed = true;
+   if (errors != nullptr) {
+      errors->error(token, message); }
    return ParseError("");
 }
 
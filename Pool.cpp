@@ -0,0 +1,134 @@
+#include "headers/Pool.h"
+#include <new>
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#define POOL_POISON(block, size)   ASAN_POISON_MEMORY_REGION(block, size)
+#define POOL_UNPOISON(block, size) ASAN_UNPOISON_MEMORY_REGION(block, size)
+#else
+#define POOL_POISON(block, size)
+#define POOL_UNPOISON(block, size)
+#endif
+
+thread_local Pool::SizeClass Pool::classes[Pool::CLASSES];
+thread_local Pool::Leftovers Pool::leftovers;
+
+void* Pool::allocate(std::size_t size)
+{
+   std::size_t index = (size + GRANULE - 1) / GRANULE - 1;
+   if (index >= CLASSES) {
+      return ::operator new(size);
+   }
+
+   SizeClass& size_class = classes[index];
+   size_class.allocations++;
+   std::size_t block_size = (index + 1) * GRANULE;
+   if (FreeBlock* block = size_class.free)
+   {
+      POOL_UNPOISON(block, block_size);
+      size_class.free = block->next;
+      size_class.reused++;
+      return block;
+   }
+   return carve(size_class, block_size);
+}
+
+void Pool::free(void* block, std::size_t size)
+{
+   std::size_t index = (size + GRANULE - 1) / GRANULE - 1;
+   if (index >= CLASSES) {
+      ::operator delete(block);
+      return;
+   }
+
+   SizeClass& size_class = classes[index];
+   size_class.frees++;
+   if (size_class.free == nullptr) {
+      static_cast<void>(&leftovers); } // * A thread that only frees blocks is counted too
+   FreeBlock* free_block = static_cast<FreeBlock*>(block);
+   free_block->next = size_class.free;
+   size_class.free = free_block;
+   POOL_POISON(block, (index + 1) * GRANULE); // * So use after free is still caught in sanitizer builds
+}
+
+void* Pool::carve(SizeClass& size_class, std::size_t block_size)
+{
+   if (size_class.unused == nullptr or size_class.unused_end - size_class.unused < static_cast<std::ptrdiff_t>(block_size))
+   {
+      static_cast<void>(&leftovers); // * Makes sure the thread hands its blocks over when it ends
+      std::vector<FreeBlock*>& adoptable = orphans[block_size / GRANULE - 1];
+      std::lock_guard<std::mutex> lock{orphans_mutex};
+      if (not adoptable.empty())
+      {
+         FreeBlock* block = adoptable.back();
+         adoptable.pop_back();
+         POOL_UNPOISON(block, block_size);
+         size_class.free = block->next;
+         size_class.reused++;
+         return block;
+      }
+      size_class.unused = static_cast<char*>(::operator new(CHUNK_SIZE));
+      chunks->push_back(size_class.unused);
+      size_class.unused_end = size_class.unused + CHUNK_SIZE / block_size * block_size;
+      size_class.chunks++;
+   }
+   void* block = size_class.unused;
+   size_class.unused += block_size;
+   return block;
+}
+
+Pool::Leftovers::Leftovers()
+{
+   std::lock_guard<std::mutex> lock{orphans_mutex};
+   ++threads;
+}
+
+// * What is left of the thread's last chunks becomes free blocks too
+Pool::Leftovers::~Leftovers()
+{
+   std::lock_guard<std::mutex> lock{orphans_mutex};
+   for (std::size_t i = 0; i < CLASSES; ++i)
+   {
+      SizeClass& size_class = classes[i];
+      outstanding += static_cast<long long>(size_class.allocations) - static_cast<long long>(size_class.frees);
+      std::size_t block_size = (i + 1) * GRANULE;
+      for (char* unused = size_class.unused; unused != nullptr and unused + block_size <= size_class.unused_end; unused += block_size) {
+         FreeBlock* block = reinterpret_cast<FreeBlock*>(unused);
+         block->next = size_class.free;
+         size_class.free = block;
+         POOL_POISON(block, block_size);
+      }
+      if (size_class.free != nullptr) {
+         orphans[i].push_back(size_class.free);
+      }
+      size_class.free = nullptr;
+      size_class.unused = size_class.unused_end = nullptr;
+   }
+   if (--threads == 0 and outstanding == 0) {
+      release_chunks(); }
+}
+
+// * Every block is free, so every free list only links blocks about to go away
+void Pool::release_chunks()
+{
+   for (void* chunk : *chunks) {
+      POOL_UNPOISON(chunk, CHUNK_SIZE);
+      ::operator delete(chunk);
+   }
+   chunks->clear();
+   for (std::size_t i = 0; i < CLASSES; ++i) {
+      orphans[i].clear(); }
+}
+
+void Pool::print_stats(std::ostream& out)
+{
+   out << "[alloc] size  allocations  from free list  live  chunks" << std::endl;
+   for (std::size_t i = 0; i < CLASSES; ++i)
+   {
+      const SizeClass& size_class = classes[i];
+      if (size_class.allocations == 0) {
+         continue; }
+      out << "[alloc] " << (i + 1) * GRANULE << "  " << size_class.allocations << "  " << size_class.reused
+          << "  " << static_cast<long long>(size_class.allocations - size_class.frees) << "  " << size_class.chunks << std::endl;
+   }
+   out << "[alloc] vectors reused " << vectors_reused << ", kept " << vectors_kept << std::endl;
+}
\ No newline at end of file
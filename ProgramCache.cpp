@@ -0,0 +1,607 @@
+#include "headers/ProgramCache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+#include <sys/stat.h>
+
+// * Changes whenever the interpreter binary is rebuilt, 0 where it can't be found and caching is then off
+static std::uint64_t stamp_of_interpreter()
+{
+   struct stat info;
+   if (stat("/proc/self/exe", &info) != 0) {
+      return 0;
+   }
+   std::uint64_t modified = static_cast<std::uint64_t>(info.st_mtim.tv_sec) * 1000000000ULL + info.st_mtim.tv_nsec;
+   return modified ^ (static_cast<std::uint64_t>(info.st_size) << 32);
+}
+
+// * FNV-1a
+static std::uint64_t hash_of(const char* begin, const char* end)
+{
+   std::uint64_t hash = 14695981039346656037ULL;
+   for (const char* c = begin; c != end; ++c) {
+      hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+   }
+   return hash;
+}
+
+static std::uint64_t hash_of(std::string_view text)
+{
+   return hash_of(text.data(), text.data() + text.size());
+}
+
+ProgramCache::ProgramCache(const std::string& source_path)
+   : path(source_path + "c"), interpreter_stamp(stamp_of_interpreter())
+{}
+
+std::string ProgramCache::header(std::string_view source) const
+{
+   std::string text = "LOXC";
+   std::uint64_t fields[] = {FORMAT_VERSION, interpreter_stamp, hash_of(source), source.size()};
+   text.append(reinterpret_cast<const char*>(fields), sizeof fields);
+   return text;
+}
+
+bool ProgramCache::load(std::string_view source, Program& program)
+{
+   if (interpreter_stamp == 0) {
+      return false;
+   }
+   std::ifstream file(path, std::ios::binary);
+   if (!file) {
+      return false;
+   }
+   std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+   std::string expected = header(source);
+   if (data.size() < expected.size() or data.compare(0, expected.size(), expected) != 0) {
+      return false;
+   }
+   return decode(source, std::string_view(data).substr(expected.size()), program);
+}
+
+// * Written to a temporary file first, so a run that is interrupted or races another never leaves half a cache behind
+void ProgramCache::store(std::string_view source, const Program& program)
+{
+   if (interpreter_stamp == 0) {
+      return;
+   }
+   std::string data = encode(source, program);
+   if (data.empty()) {
+      return;
+   }
+   data = header(source) + data;
+
+   std::string temporary = path + ".tmp";
+   {
+      std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+      if (!file.write(data.data(), data.size())) {
+         std::remove(temporary.c_str());
+         return;
+      }
+   }
+   if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+      std::remove(temporary.c_str());
+   }
+}
+
+// * Token positions are 32 bits, so sources of 4 GiB and more are never cached
+std::string ProgramCache::encode(std::string_view source, const Program& program)
+{
+   if (source.size() > UINT32_MAX) {
+      return "";
+   }
+   try
+   {
+      write(program.statements);
+      std::string tree = std::move(out);
+
+      write_count(tokens.size());
+      for (const Token* token : tokens)
+      {
+         std::size_t offset = token->lexeme.data() - source.data();
+         if (token->lexeme.data() < source.data() or offset + token->lexeme.size() > source.size()) {
+            return ""; // * Not scanned from this source, it can't be stored as a position in it
+         }
+         write(static_cast<std::uint8_t>(token->type));
+         write(static_cast<std::int32_t>(token->line));
+         write(static_cast<std::uint32_t>(offset));
+         write(static_cast<std::uint32_t>(token->lexeme.size()));
+      }
+      out += tree;
+   }
+   catch (const TooLarge&) {
+      return "";
+   }
+   write(hash_of(out));
+   return std::move(out);
+}
+
+bool ProgramCache::decode(std::string_view source, std::string_view data, Program& a_program)
+{
+   std::uint64_t checksum;
+   if (data.size() < sizeof checksum) {
+      return false;
+   }
+   in = data.data();
+   end = data.data() + data.size() - sizeof checksum;
+   std::memcpy(&checksum, end, sizeof checksum);
+   if (checksum != hash_of(in, end)) {
+      return false;
+   }
+   program = &a_program;
+   try
+   {
+      std::uint32_t count = read_count();
+      program->tokens.reserve(count); // * Nodes refer to the tokens, they must not move
+      for (std::uint32_t i = 0; i < count; ++i)
+      {
+         std::uint8_t type = read<std::uint8_t>();
+         std::int32_t line = read<std::int32_t>();
+         std::uint32_t offset = read<std::uint32_t>();
+         std::uint32_t length = read<std::uint32_t>();
+         if (type > END_OF_FILE or offset > source.size() or length > source.size() - offset) {
+            throw Corrupt{};
+         }
+         program->tokens.emplace_back(static_cast<TokenType>(type), source.substr(offset, length), line);
+      }
+      program->statements = read_statements();
+      if (in != end) {
+         throw Corrupt{};
+      }
+   }
+   catch (const Corrupt&) {
+      return false;
+   }
+   return true;
+}
+
+template <typename T>
+void ProgramCache::write(T value)
+{
+   static_assert(std::is_arithmetic_v<T>, "only numbers are written as raw bytes");
+   out.append(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+void ProgramCache::write_count(std::size_t count)
+{
+   if (count > UINT32_MAX) {
+      throw TooLarge{};
+   }
+   write(static_cast<std::uint32_t>(count));
+}
+
+void ProgramCache::write(const std::string& text)
+{
+   write_count(text.size());
+   out += text;
+}
+
+// * Tokens are numbered in the order they are first written
+void ProgramCache::write(const Token& token)
+{
+   auto elem = token_indices.find(&token);
+   if (elem == token_indices.end()) {
+      if (tokens.size() >= UINT32_MAX) {
+         throw TooLarge{}; }
+      elem = token_indices.emplace(&token, tokens.size()).first;
+      tokens.push_back(&token);
+   }
+   write(elem->second);
+}
+
+void ProgramCache::write(const Resolution& resolution)
+{
+   write(static_cast<std::int32_t>(resolution.depth));
+   write(static_cast<std::int32_t>(resolution.slot));
+}
+
+void ProgramCache::write(Expr* expr)
+{
+   if (expr == nullptr) {
+      write(static_cast<std::uint8_t>(NONE));
+      return;
+   }
+   expr->accept(*this);
+}
+
+void ProgramCache::write(Stmt* stmt)
+{
+   if (stmt == nullptr) {
+      write(static_cast<std::uint8_t>(NONE));
+      return;
+   }
+   stmt->accept(*this);
+}
+
+void ProgramCache::write(const std::vector<Stmt*>& statements)
+{
+   write_count(statements.size());
+   for (Stmt* stmt : statements) {
+      write(stmt);
+   }
+}
+
+void ProgramCache::write_function(Function* function)
+{
+   write(function->name);
+   write_count(function->params.size());
+   for (const Token* param : function->params) {
+      write(*param);
+   }
+   write(function->body);
+}
+
+template <typename T>
+T ProgramCache::read()
+{
+   if (static_cast<std::size_t>(end - in) < sizeof(T)) {
+      throw Corrupt{};
+   }
+   T value;
+   std::memcpy(&value, in, sizeof value);
+   in += sizeof value;
+   return value;
+}
+
+// * Every element takes at least a byte, so a count can't be larger than what is left of the file
+std::uint32_t ProgramCache::read_count()
+{
+   std::uint32_t count = read<std::uint32_t>();
+   if (count > static_cast<std::size_t>(end - in)) {
+      throw Corrupt{};
+   }
+   return count;
+}
+
+std::string ProgramCache::read_string()
+{
+   std::uint32_t size = read_count();
+   std::string text(in, size);
+   in += size;
+   return text;
+}
+
+const Token& ProgramCache::read_token()
+{
+   std::uint32_t index = read<std::uint32_t>();
+   if (index >= program->tokens.size()) {
+      throw Corrupt{};
+   }
+   return program->tokens[index];
+}
+
+Resolution ProgramCache::read_resolution()
+{
+   Resolution resolution;
+   resolution.depth = read<std::int32_t>();
+   resolution.slot = read<std::int32_t>();
+   return resolution;
+}
+
+Expr* ProgramCache::read_expr()
+{
+   Arena& arena = program->arena;
+   switch (read<std::uint8_t>())
+   {
+      case NONE: return nullptr;
+      case BINARY: {
+         Expr* left = read_expr();
+         const Token& op = read_token();
+         return arena.make<Binary>(left, op, read_expr());
+      }
+      case GROUP: return arena.make<Group>(read_expr());
+      case LITERAL: {
+         const Token& token = read_token();
+         switch (static_cast<ValueType>(read<std::uint8_t>()))
+         {
+            case ValueType::NIL:    return arena.make<Literal>(token, Value());
+            case ValueType::BOOL:   return arena.make<Literal>(token, Value(read<std::uint8_t>() != 0));
+            case ValueType::NUMBER: return arena.make<Literal>(token, Value(read<double>()));
+            case ValueType::STRING: return arena.make<Literal>(token, Value(read_string()));
+            default: throw Corrupt{};
+         }
+      }
+      case UNARY: {
+         const Token& op = read_token();
+         return arena.make<Unary>(op, read_expr());
+      }
+      case VARIABLE: {
+         Variable* variable = arena.make<Variable>(read_token());
+         variable->resolution = read_resolution();
+         return variable;
+      }
+      case ASSIGN: {
+         const Token& name = read_token();
+         Assign* assign = arena.make<Assign>(name, read_expr());
+         assign->resolution = read_resolution();
+         return assign;
+      }
+      case LOGICAL: {
+         Expr* left = read_expr();
+         const Token& op = read_token();
+         return arena.make<Logical>(left, op, read_expr());
+      }
+      case CALL: {
+         Expr* callee = read_expr();
+         const Token& paren = read_token();
+         std::vector<Expr*> arguments(read_count());
+         for (Expr*& argument : arguments) {
+            argument = read_expr();
+         }
+         return arena.make<Call>(callee, paren, std::move(arguments));
+      }
+      case GET: {
+         Expr* object = read_expr();
+         return arena.make<Get>(object, read_token());
+      }
+      case SET: {
+         Expr* object = read_expr();
+         const Token& name = read_token();
+         return arena.make<Set>(object, name, read_expr());
+      }
+      case THIS: {
+         This* this_expr = arena.make<This>(read_token());
+         this_expr->resolution = read_resolution();
+         return this_expr;
+      }
+      case SUPER: {
+         const Token& keyword = read_token();
+         Super* super_expr = arena.make<Super>(keyword, read_token());
+         super_expr->resolution = read_resolution();
+         return super_expr;
+      }
+      default: throw Corrupt{};
+   }
+}
+
+Stmt* ProgramCache::read_stmt()
+{
+   Arena& arena = program->arena;
+   switch (read<std::uint8_t>())
+   {
+      case NONE:       return nullptr;
+      case EXPRESSION: return arena.make<Expression>(read_expr());
+      case PRINT:      return arena.make<Print>(read_expr());
+      case VAR: {
+         const Token& name = read_token();
+         return arena.make<Var>(name, read_expr());
+      }
+      case BLOCK: return arena.make<Block>(read_statements());
+      case IF: {
+         const Token& keyword = read_token();
+         Expr* condition = read_expr();
+         Stmt* then_branch = read_stmt();
+         return arena.make<If>(keyword, condition, then_branch, read_stmt());
+      }
+      case WHILE: {
+         const Token& keyword = read_token();
+         Expr* condition = read_expr();
+         return arena.make<While>(keyword, condition, read_stmt());
+      }
+      case FUNCTION: return read_function();
+      case RETURN: {
+         const Token& keyword = read_token();
+         return arena.make<Return>(keyword, read_expr());
+      }
+      case CLASS: {
+         const Token& name = read_token();
+         Expr* superclass = read_expr();
+         Variable* superclass_variable = dynamic_cast<Variable*>(superclass);
+         if (superclass != nullptr and superclass_variable == nullptr) {
+            throw Corrupt{};
+         }
+         std::vector<Function*> methods(read_count());
+         for (Function*& method : methods) {
+            method = read_function();
+         }
+         return arena.make<Class>(name, superclass_variable, std::move(methods));
+      }
+      default: throw Corrupt{};
+   }
+}
+
+std::vector<Stmt*> ProgramCache::read_statements()
+{
+   std::vector<Stmt*> statements(read_count());
+   for (Stmt*& stmt : statements) {
+      stmt = read_stmt();
+   }
+   return statements;
+}
+
+Function* ProgramCache::read_function()
+{
+   const Token& name = read_token();
+   std::vector<const Token*> params(read_count());
+   for (const Token*& param : params) {
+      param = &read_token();
+   }
+   return program->arena.make<Function>(name, std::move(params), read_statements());
+}
+
+Value ProgramCache::visit_BinaryExpr(Binary* expr)
+{
+   write(static_cast<std::uint8_t>(BINARY));
+   write(expr->left);
+   write(expr->op);
+   write(expr->right);
+   return nullptr;
+}
+
+Value ProgramCache::visit_GroupExpr(Group* expr)
+{
+   write(static_cast<std::uint8_t>(GROUP));
+   write(expr->expr_in);
+   return nullptr;
+}
+
+Value ProgramCache::visit_LiteralExpr(Literal* expr)
+{
+   write(static_cast<std::uint8_t>(LITERAL));
+   write(expr->token);
+   write(static_cast<std::uint8_t>(expr->value.type()));
+   if (expr->value.is_bool()) {
+      write(static_cast<std::uint8_t>(expr->value.as_bool())); }
+   else if (expr->value.is_number()) {
+      write(expr->value.as_number()); }
+   else if (expr->value.is_string()) {
+      write(expr->value.as_string()); }
+   return nullptr;
+}
+
+Value ProgramCache::visit_UnaryExpr(Unary* expr)
+{
+   write(static_cast<std::uint8_t>(UNARY));
+   write(expr->op);
+   write(expr->right);
+   return nullptr;
+}
+
+Value ProgramCache::visit_VariableExpr(Variable* expr)
+{
+   write(static_cast<std::uint8_t>(VARIABLE));
+   write(expr->name);
+   write(expr->resolution);
+   return nullptr;
+}
+
+Value ProgramCache::visit_AssignExpr(Assign* expr)
+{
+   write(static_cast<std::uint8_t>(ASSIGN));
+   write(expr->name);
+   write(expr->value);
+   write(expr->resolution);
+   return nullptr;
+}
+
+Value ProgramCache::visit_LogicalExpr(Logical* expr)
+{
+   write(static_cast<std::uint8_t>(LOGICAL));
+   write(expr->left);
+   write(expr->op);
+   write(expr->right);
+   return nullptr;
+}
+
+Value ProgramCache::visit_CallExpr(Call* expr)
+{
+   write(static_cast<std::uint8_t>(CALL));
+   write(expr->calle);
+   write(expr->paren);
+   write_count(expr->arguements.size());
+   for (Expr* argument : expr->arguements) {
+      write(argument);
+   }
+   return nullptr;
+}
+
+Value ProgramCache::visit_GetExpr(Get* expr)
+{
+   write(static_cast<std::uint8_t>(GET));
+   write(expr->object);
+   write(expr->name);
+   return nullptr;
+}
+
+Value ProgramCache::visit_SetExpr(Set* expr)
+{
+   write(static_cast<std::uint8_t>(SET));
+   write(expr->object);
+   write(expr->name);
+   write(expr->value);
+   return nullptr;
+}
+
+Value ProgramCache::visit_ThisExpr(This* expr)
+{
+   write(static_cast<std::uint8_t>(THIS));
+   write(expr->keyword);
+   write(expr->resolution);
+   return nullptr;
+}
+
+Value ProgramCache::visit_SuperExpr(Super* expr)
+{
+   write(static_cast<std::uint8_t>(SUPER));
+   write(expr->keyword);
+   write(expr->method);
+   write(expr->resolution);
+   return nullptr;
+}
+
+Completion ProgramCache::visit_ExpressionStmt(Expression* stmt)
+{
+   write(static_cast<std::uint8_t>(EXPRESSION));
+   write(stmt->expression);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_PrintStmt(Print* stmt)
+{
+   write(static_cast<std::uint8_t>(PRINT));
+   write(stmt->expression);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_VarStmt(Var* stmt)
+{
+   write(static_cast<std::uint8_t>(VAR));
+   write(stmt->name);
+   write(stmt->initializer);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_BlockStmt(Block* stmt)
+{
+   write(static_cast<std::uint8_t>(BLOCK));
+   write(stmt->statements);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_IfStmt(If* stmt)
+{
+   write(static_cast<std::uint8_t>(IF));
+   write(stmt->keyword);
+   write(stmt->condition);
+   write(stmt->then_branch);
+   write(stmt->else_branch);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_WhileStmt(While* stmt)
+{
+   write(static_cast<std::uint8_t>(WHILE));
+   write(stmt->keyword);
+   write(stmt->condition);
+   write(stmt->body);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_FunctionStmt(Function* stmt)
+{
+   write(static_cast<std::uint8_t>(FUNCTION));
+   write_function(stmt);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_ReturnStmt(Return* stmt)
+{
+   write(static_cast<std::uint8_t>(RETURN));
+   write(stmt->keyword);
+   write(stmt->value);
+   return Completion{};
+}
+
+Completion ProgramCache::visit_ClassStmt(Class* stmt)
+{
+   write(static_cast<std::uint8_t>(CLASS));
+   write(stmt->name);
+   write(static_cast<Expr*>(stmt->superclass));
+   write_count(stmt->methods.size());
+   for (Function* method : stmt->methods) {
+      write_function(method);
+   }
+   return Completion{};
+}
\ No newline at end of file
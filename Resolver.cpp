@@ -1,28 +1,23 @@
 #include "headers/Resolver.h"
-#include "headers/Lox.h"
 #include <algorithm>
 
-Resolver::Resolver(Interpreter& interpreter)
-  : interpreter(interpreter)
-{}
-
-void Resolver::resolve(std::vector<std::shared_ptr<Stmt>> statements)
+void Resolver::resolve(std::vector<Stmt*> statements)
 {
-   for (std::shared_ptr<Stmt>& stmt : statements) {
+   for (Stmt*& stmt : statements) {
       resolve(stmt);
    }
 }
 
-std::any Resolver::visit_BlockStmt(std::shared_ptr<Block> stmt)
+Completion Resolver::visit_BlockStmt(Block* stmt)
 {  
    begin_scope();
    resolve(stmt->statements);
    end_scope();
 
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_ClassStmt(std::shared_ptr<Class> stmt)
+Completion Resolver::visit_ClassStmt(Class* stmt)
 {
    ClassType enclosing_class = current_class;
    current_class = ClassType::CLASS;
@@ -32,7 +27,7 @@ std::any Resolver::visit_ClassStmt(std::shared_ptr<Class> stmt)
 
    if (stmt->superclass != nullptr and stmt->name.lexeme == stmt->superclass->name.lexeme)
    {
-      Lox::error(stmt->superclass->name,  "A class can't inherit from itself.");
+      errors.error(stmt->superclass->name,  "A class can't inherit from itself.");
    }
 
    if (stmt->superclass != nullptr) {
@@ -42,38 +37,35 @@ std::any Resolver::visit_ClassStmt(std::shared_ptr<Class> stmt)
 
    if (stmt->superclass != nullptr) {
       begin_scope();      // * <- If begin scope here
-      scopes.back()["super"] = true;
+      define_internal("super");
     }
 
-   begin_scope();
-   scopes.back()["this"] = true; 
-   for (std::shared_ptr<Function> method: stmt->methods) {
+   for (Function* method: stmt->methods) {
       FunctionType declaration = FunctionType::METHOD;
       if (method->name.lexeme == "init") {
         declaration = FunctionType::INITIALIZER;
       }
       resolve_function(method, declaration);
    }  
-   end_scope();
 
    if (stmt->superclass != nullptr) { 
       end_scope(); // * <- Then end scope here
    }
 
    current_class = enclosing_class;
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_FunctionStmt(std::shared_ptr<Function> stmt)
+Completion Resolver::visit_FunctionStmt(Function* stmt)
 {
    declare(stmt->name);
    define(stmt->name);
 
    resolve_function(stmt, FunctionType::FUNCTION);
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_VarStmt(std::shared_ptr<Var> stmt)
+Completion Resolver::visit_VarStmt(Var* stmt)
 {
    declare(stmt->name);
    if (stmt->initializer != nullptr)
@@ -82,169 +74,169 @@ std::any Resolver::visit_VarStmt(std::shared_ptr<Var> stmt)
    }
    define(stmt->name);
 
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_ExpressionStmt(std::shared_ptr<Expression> stmt)
+Completion Resolver::visit_ExpressionStmt(Expression* stmt)
 {
    resolve(stmt->expression);
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_IfStmt(std::shared_ptr<If> stmt)
+Completion Resolver::visit_IfStmt(If* stmt)
 {
    resolve(stmt->condition);
    resolve(stmt->then_branch);
    if (stmt->else_branch != nullptr) { resolve(stmt->else_branch); }
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_PrintStmt(std::shared_ptr<Print> stmt)
+Completion Resolver::visit_PrintStmt(Print* stmt)
 {
    resolve(stmt->expression);
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_ReturnStmt(std::shared_ptr<Return> stmt)
+Completion Resolver::visit_ReturnStmt(Return* stmt)
 {
    if (current_function == FunctionType::NONE) {
-      Lox::error(stmt->keyword, "Can't return from top-level code.");
+      errors.error(stmt->keyword, "Can't return from top-level code.");
    }
 
    if (stmt->value != nullptr) {
       if (current_function == FunctionType::INITIALIZER) {
-        Lox::error(stmt->keyword, "Can't return a value from an initializer.");
+        errors.error(stmt->keyword, "Can't return a value from an initializer.");
       }
 
       resolve(stmt->value);
    }
 
-   return nullptr;
+   return {};
 }
 
-std::any Resolver::visit_WhileStmt(std::shared_ptr<While> stmt)
+Completion Resolver::visit_WhileStmt(While* stmt)
 {
    resolve(stmt->condition);
    resolve(stmt->body);
-   return nullptr;
+   return {};
 }
 
 
-std::any Resolver::visit_AssignExpr(std::shared_ptr<Assign> expr)
+Value Resolver::visit_AssignExpr(Assign* expr)
 {
    resolve(expr->value);
-   resolve_local(expr, expr->name);
+   resolve_local(expr->resolution, expr->name);
    return nullptr;
 }
 
-std::any Resolver::visit_VariableExpr(std::shared_ptr<Variable> expr)
+Value Resolver::visit_VariableExpr(Variable* expr)
 {
    if (!scopes.empty())
    {
       auto& scope = scopes.back();
       auto elem = scope.find(expr->name.lexeme);
-      if (elem != scope.end() && elem->second == false){
-         Lox::error(expr->name, "Can't read local variable in its own initializer.");
+      if (elem != scope.end() && elem->second.defined == false){
+         errors.error(expr->name, "Can't read local variable in its own initializer.");
       }
    }
-   resolve_local(expr, expr->name);
+   resolve_local(expr->resolution, expr->name);
    return nullptr;
 }
 
-std::any Resolver::visit_BinaryExpr(std::shared_ptr<Binary> expr)
+Value Resolver::visit_BinaryExpr(Binary* expr)
 {
    resolve(expr->left);
    resolve(expr->right);
    return nullptr;
 }
 
-std::any Resolver::visit_CallExpr(std::shared_ptr<Call> expr)
+Value Resolver::visit_CallExpr(Call* expr)
 {
    resolve(expr->calle);
 
-   for (std::shared_ptr<Expr> argument : expr->arguements) {
+   for (Expr* argument : expr->arguements) {
       resolve(argument);
    }
 
    return nullptr;
 }
 
-std::any Resolver::visit_GetExpr(std::shared_ptr<Get> expr)
+Value Resolver::visit_GetExpr(Get* expr)
 {
    resolve(expr->object);
    return nullptr;
 }
 
-std::any Resolver::visit_SetExpr(std::shared_ptr<Set> expr)
+Value Resolver::visit_SetExpr(Set* expr)
 {
    resolve(expr->value);
    resolve(expr->object);
    return nullptr;
 }
 
- std::any Resolver::visit_SuperExpr(std::shared_ptr<Super> expr)
+ Value Resolver::visit_SuperExpr(Super* expr)
  {
    if (current_class == ClassType::NONE) {
-      Lox::error(expr->keyword, "Can't use 'super' outside of a class.");
+      errors.error(expr->keyword, "Can't use 'super' outside of a class.");
    } 
    else if (current_class != ClassType::SUBCLASS) 
    {
-      Lox::error(expr->keyword, "Can't use 'super' in a class with no superclass.");
+      errors.error(expr->keyword, "Can't use 'super' in a class with no superclass.");
    }
 
-   resolve_local(expr, expr->keyword);
+   resolve_local(expr->resolution, expr->keyword);
    return nullptr;
  }
 
-std::any Resolver::visit_ThisExpr(std::shared_ptr<This> expr)
+Value Resolver::visit_ThisExpr(This* expr)
 {
    if (current_class == ClassType::NONE) {
-      Lox::error(expr->keyword, "Can't use 'this' outside of a class.");
+      errors.error(expr->keyword, "Can't use 'this' outside of a class.");
       return nullptr;
    }
 
-   resolve_local(expr, expr->keyword);
+   resolve_local(expr->resolution, expr->keyword);
    return nullptr;
 }
 
-std::any Resolver::visit_GroupExpr(std::shared_ptr<Group> expr)
+Value Resolver::visit_GroupExpr(Group* expr)
 {
    resolve(expr->expr_in);
    return nullptr;
 }
 
-std::any Resolver::visit_LiteralExpr(std::shared_ptr<Literal> expr)
+Value Resolver::visit_LiteralExpr(Literal* expr)
 {
    return nullptr;
 }
 
-std::any Resolver::visit_LogicalExpr(std::shared_ptr<Logical> expr)
+Value Resolver::visit_LogicalExpr(Logical* expr)
 {
    resolve(expr->left);
    resolve(expr->right);
    return nullptr;
 }
 
-std::any Resolver::visit_UnaryExpr(std::shared_ptr<Unary> expr)
+Value Resolver::visit_UnaryExpr(Unary* expr)
 {
    resolve(expr->right);
    return nullptr;
 }
 
 
-void Resolver::resolve(std::shared_ptr<Stmt> stmt)
+void Resolver::resolve(Stmt* stmt)
 {
    stmt->accept(*this);
 }
 
-void Resolver::resolve(std::shared_ptr<Expr> expr)
+void Resolver::resolve(Expr* expr)
 {
    expr->accept(*this);
 }
 
 void Resolver::begin_scope()
 {
-   scopes.push_back(std::map<std::string, bool>{});
+   scopes.push_back(std::map<std::string_view, ScopeVariable>{});
 }
 
 void Resolver::end_scope()
@@ -252,43 +244,58 @@ void Resolver::end_scope()
    scopes.pop_back();
 }
 
-void Resolver::declare(Token name)
+void Resolver::declare(const Token& name)
 {
    if (scopes.empty()) { return; }
-   std::map<std::string, bool>& scope = scopes.back();
+   std::map<std::string_view, ScopeVariable>& scope = scopes.back();
    if (scope.find(name.lexeme) != scope.end()) {
-      Lox::error(name, "Already a variable with this name in this scope.");
+      errors.error(name, "Already a variable with this name in this scope.");
+      return;
    }
-   scope[name.lexeme] = false;
+   int slot = scope.size();
+   scope[name.lexeme] = ScopeVariable{false, slot};
 }
 
-void Resolver::define(Token name)
+void Resolver::define(const Token& name)
 {
    if (scopes.empty()) { return; }
-   scopes.back()[name.lexeme] = true;
+   scopes.back()[name.lexeme].defined = true;
 }
 
-void Resolver::resolve_local(std::shared_ptr<Expr> expr, Token name)
+// * For the variables the interpreter defines itself: "this" and "super"
+void Resolver::define_internal(std::string_view name)
+{
+   std::map<std::string_view, ScopeVariable>& scope = scopes.back();
+   int slot = scope.size();
+   scope[name] = ScopeVariable{true, slot};
+}
+
+void Resolver::resolve_local(Resolution& resolution, const Token& name)
 {
    for (int i = scopes.size()-1 ; i>= 0; --i)
    {
-      if (scopes[i].find(name.lexeme) != scopes[i].end() )
+      auto elem = scopes[i].find(name.lexeme);
+      if (elem != scopes[i].end() )
       {
-         interpreter.resolve(expr, scopes.size() - 1 - i);
+         resolution.depth = scopes.size() - 1 - i;
+         resolution.slot = elem->second.slot;
          return;
       }
    }
 }
 
-void Resolver::resolve_function(std::shared_ptr<Function> function, FunctionType type)
+void Resolver::resolve_function(Function* function, FunctionType type)
 {
    FunctionType enclosing_function = current_function;
    current_function = type;
 
    begin_scope();
-   for (Token param : function->params) {
-      declare(param);
-      define(param);
+   if (type == FunctionType::METHOD or type == FunctionType::INITIALIZER) {
+      define_internal("this"); // * Methods get "this" in the first slot of their frame, before the parameters
+   }
+   for (const Token* param : function->params) {
+      declare(*param);
+      define(*param);
    }
    resolve(function->body);
    end_scope();
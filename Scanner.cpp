@@ -1,8 +1,23 @@
 #include "headers/Scanner.h"
-#include "headers/Lox.h"
+#include "headers/DeclarationBoundary.h"
+#include <array>
+#include <charconv>
+#include <cstring>
 #include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-std::unordered_map<std::string, TokenType> Scanner::keywords = {
+/*
+   The keywords' perfect hash: the first two characters and the length pick one of 32 slots, no two keywords share one.
+   The table is built and checked by the compiler, a lookup is one hash and at most one comparison
+*/
+struct Keyword {
+   std::string_view text;
+   TokenType type;
+};
+
+static constexpr Keyword KEYWORDS[] = {
    {"and",    AND},
    {"class",  CLASS},
    {"else",   ELSE},
@@ -21,20 +36,176 @@ std::unordered_map<std::string, TokenType> Scanner::keywords = {
    {"while",  WHILE},
 };
 
+static constexpr std::size_t KEYWORD_MIN_LENGTH = 2;
+static constexpr std::size_t KEYWORD_MAX_LENGTH = 6;
 
-Scanner::Scanner(const std::string& a_source)
-:  source(a_source)
-{  }
+// * Only called with KEYWORD_MIN_LENGTH or more characters
+static constexpr unsigned keyword_hash(std::string_view text)
+{
+   return (static_cast<unsigned char>(text[0]) + static_cast<unsigned char>(text[1]) * 18 + text.size() * 7) & 31;
+}
+
+static constexpr std::array<Keyword, 32> make_keyword_table()
+{
+   std::array<Keyword, 32> table{};
+   for (Keyword& slot : table) {
+      slot = Keyword{"", IDENTIFIER};
+   }
+   for (const Keyword& keyword : KEYWORDS) {
+      table[keyword_hash(keyword.text)] = keyword;
+   }
+   return table;
+}
+
+static constexpr std::array<Keyword, 32> KEYWORD_TABLE = make_keyword_table();
+
+static constexpr bool keyword_table_is_perfect()
+{
+   for (const Keyword& keyword : KEYWORDS) {
+      if (keyword.text.size() < KEYWORD_MIN_LENGTH or keyword.text.size() > KEYWORD_MAX_LENGTH
+          or KEYWORD_TABLE[keyword_hash(keyword.text)].text != keyword.text) {
+         return false;
+      }
+   }
+   return true;
+}
+static_assert(keyword_table_is_perfect(), "two keywords hash to the same slot, pick other multipliers in keyword_hash");
+
+TokenType Scanner::keyword_type(std::string_view text)
+{
+   if (text.size() < KEYWORD_MIN_LENGTH or text.size() > KEYWORD_MAX_LENGTH) {
+      return IDENTIFIER;
+   }
+   const Keyword& keyword = KEYWORD_TABLE[keyword_hash(text)];
+   return keyword.text == text ? keyword.type : IDENTIFIER;
+}
+
+static bool is_digit(char c) { return c >= '0' and c <= '9'; }
+static bool is_alpha(char c) { return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z'); }
+static bool is_alpha_numeric(char c) { return is_alpha(c) or is_digit(c) or c == '_'; }
+static bool is_blank(char c) { return c == ' ' or c == '\r' or c == '\t' or c == '\n'; }
+
+/*
+   Block scans: each returns the index of the first byte at or after from that ends the run it measures, or size.
+   The SSE2 loops only load whole blocks of 16 bytes inside the text, the scalar loops after them finish the tail
+*/
+#if defined(__SSE2__)
+static constexpr std::size_t BLOCK = 16;
 
-void Scanner::add_token(TokenType type)
+static __m128i load_block(const char* text, std::size_t from)
 {
-   add_token(type, nullptr);   
+   return _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + from));
 }
 
-void Scanner::add_token(TokenType type, std::any literal)
+static __m128i in_range(__m128i block, char low, char high)
 {
-   std::string text = source.substr(start, current - start);
-   tokens.push_back(Token(type, text, literal, line));
+   return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(low - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(high + 1), block));
+}
+
+static __m128i digits_of(__m128i block)
+{
+   return in_range(block, '0', '9');
+}
+
+// * Bytes of 0x80 and above are negative as signed chars, so they fall outside every range
+static __m128i identifier_characters_of(__m128i block)
+{
+   __m128i letters = in_range(_mm_or_si128(block, _mm_set1_epi8(0x20)), 'a', 'z');
+   __m128i underscores = _mm_cmpeq_epi8(block, _mm_set1_epi8('_'));
+   return _mm_or_si128(_mm_or_si128(letters, digits_of(block)), underscores);
+}
+#endif
+
+// * Blank space, counting the newlines it passes
+static std::size_t skip_blanks(std::string_view text, std::size_t from, int& line)
+{
+#if defined(__SSE2__)
+   while (from + BLOCK <= text.size())
+   {
+      __m128i block = load_block(text.data(), from);
+      __m128i newlines = _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'));
+      __m128i blanks = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\t'))),
+                                    _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')), newlines));
+      unsigned others = ~_mm_movemask_epi8(blanks) & 0xFFFF;
+      unsigned newline_mask = _mm_movemask_epi8(newlines);
+      if (others != 0) {
+         unsigned skipped = __builtin_ctz(others);
+         line += __builtin_popcount(newline_mask & ((1u << skipped) - 1));
+         return from + skipped;
+      }
+      line += __builtin_popcount(newline_mask);
+      from += BLOCK;
+   }
+#endif
+   for (; from < text.size() and is_blank(text[from]); ++from) {
+      if (text[from] == '\n') { line++; }
+   }
+   return from;
+}
+
+// * The closing quote of a string, counting the newlines inside it
+static std::size_t find_string_end(std::string_view text, std::size_t from, int& line)
+{
+#if defined(__SSE2__)
+   while (from + BLOCK <= text.size())
+   {
+      __m128i block = load_block(text.data(), from);
+      unsigned quotes = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')));
+      unsigned newline_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+      if (quotes != 0) {
+         unsigned length = __builtin_ctz(quotes);
+         line += __builtin_popcount(newline_mask & ((1u << length) - 1));
+         return from + length;
+      }
+      line += __builtin_popcount(newline_mask);
+      from += BLOCK;
+   }
+#endif
+   for (; from < text.size() and text[from] != '"'; ++from) {
+      if (text[from] == '\n') { line++; }
+   }
+   return from;
+}
+
+static std::size_t find_identifier_end(std::string_view text, std::size_t from)
+{
+#if defined(__SSE2__)
+   while (from + BLOCK <= text.size())
+   {
+      unsigned others = ~_mm_movemask_epi8(identifier_characters_of(load_block(text.data(), from))) & 0xFFFF;
+      if (others != 0) {
+         return from + __builtin_ctz(others);
+      }
+      from += BLOCK;
+   }
+#endif
+   while (from < text.size() and is_alpha_numeric(text[from])) { ++from; }
+   return from;
+}
+
+static std::size_t find_digits_end(std::string_view text, std::size_t from)
+{
+#if defined(__SSE2__)
+   while (from + BLOCK <= text.size())
+   {
+      unsigned others = ~_mm_movemask_epi8(digits_of(load_block(text.data(), from))) & 0xFFFF;
+      if (others != 0) {
+         return from + __builtin_ctz(others);
+      }
+      from += BLOCK;
+   }
+#endif
+   while (from < text.size() and is_digit(text[from])) { ++from; }
+   return from;
+}
+
+Scanner::Scanner(std::string_view a_source, ErrorReporter& errors)
+:  source(a_source), errors(errors)
+{  }
+
+void Scanner::add_token(TokenType type, double number)
+{
+   tokens.push_back(Token(type, source.substr(start, current - start), line, number));
 }
 
 char Scanner::peek()
@@ -59,13 +230,57 @@ bool Scanner::match(char expected)
 
 std::vector<Token> Scanner::scan_tokens()
 {
-   while (not is_at_end())
+   // * A guess of a token per 4 bytes saves most of the regrowing, capacity that is never written costs no memory
+   tokens.reserve(source.size() / 4 + 1);
+   while (true)
    {
+      current = skip_blanks(source, current, line);
+      if (is_at_end()) {
+         break; }
       start = current;
       scan_token();
    }
-   tokens.push_back(Token(END_OF_FILE, "end", "", line));
-   return tokens;
+   tokens.push_back(Token(END_OF_FILE, "end", line));
+   return std::move(tokens);
+}
+
+// * Where a declaration ends is decided by DeclarationBoundary, the token after it is kept for the next call
+std::vector<Token> Scanner::scan_declaration()
+{
+   std::vector<Token> declaration;
+   DeclarationBoundary boundary;
+   Token token = next_token();
+   for (; token.type != END_OF_FILE; token = next_token())
+   {
+      if (boundary.starts_declaration(token)) {
+         lookahead = token;
+         break;
+      }
+      declaration.push_back(token);
+   }
+   declaration.push_back(Token(END_OF_FILE, "end", token.line));
+   return declaration;
+}
+
+// * The tokens vector only buffers the token scan_token adds, comments and bad characters add none
+Token Scanner::next_token()
+{
+   if (lookahead) {
+      Token token = *lookahead;
+      lookahead.reset();
+      return token;
+   }
+   while (tokens.empty())
+   {
+      current = skip_blanks(source, current, line);
+      if (is_at_end()) {
+         return Token(END_OF_FILE, "end", line); }
+      start = current;
+      scan_token();
+   }
+   Token token = tokens.back();
+   tokens.pop_back();
+   return token;
 }
 
 void Scanner::scan_token()
@@ -98,33 +313,23 @@ void Scanner::scan_token()
       case '/':
         if (match('/')) {
             // A comment goes until the end of the line.
-            while (peek() != '\n' && !is_at_end()) 
-               { advance(); }
+            const void* end_of_line = std::memchr(source.data() + current, '\n', source.size() - current);
+            current = end_of_line ? static_cast<const char*>(end_of_line) - source.data() : source.size();
         } 
         else {
             add_token(SLASH);
         }
         break;
 
-      // Ignore whitespace.
-      case ' ':
-      case '\r':
-      case '\t':
-         break;
-
-      case '\n':
-         line++;
-         break;
-
       case '"': string(); break;
 
       default:
-         if (isdigit(c)) { number(); }
-         else if (isalpha(c)) {
+         if (is_digit(c)) { number(); }
+         else if (is_alpha(c)) {
             identifier();
          }
          else {
-            Lox::error(line, "Unexpected character: " + c);
+            errors.error(line, std::string("Unexpected character: ") + c);
             break;
          }
     }
@@ -132,58 +337,35 @@ void Scanner::scan_token()
 
 void Scanner::string()
 {
-   while (peek() != '"' && !is_at_end()) {
-      if (peek() == '\n') { 
-         line++; 
-      }
-      advance();
-   }
+   current = find_string_end(source, current, line);
    if (is_at_end()) {
-      Lox::error(line, "Unterminated string.");
+      errors.error(line, "Unterminated string.");
       return;
    }
    // The closing ".
    advance();
-   // Trim the surrounding quotes.
-   std::string value = source.substr(start + 1, current - start - 2);
-   add_token(STRING, value);
+   // * The value is the lexeme without its quotes, see Token::string_value
+   add_token(STRING);
 }
 
 void Scanner::number()
 {
-   while (isdigit( peek() )) {
-      advance();
-   }
+   current = find_digits_end(source, current);
     // Look for a fractional part.
-   if (peek() == '.' && isdigit( peek_next() )) 
+   if (peek() == '.' && is_digit( peek_next() )) 
    {
       // Consume the "."
       advance();
-      while (isdigit( peek() )) {
-         advance();
-      }
+      current = find_digits_end(source, current);
    }
 
-   add_token(NUMBER, 
-       std::stod(source.substr(start, current-start)) 
-   );
+   double value = 0;
+   std::from_chars(source.data() + start, source.data() + current, value);
+   add_token(NUMBER, value);
 }
 
 void Scanner::identifier()
 {
-   while (isalnum(peek()) or peek() == '_') {
-      advance();
-   }
-   std::string text = source.substr(start, current-start);   
-   auto is_in_map = keywords.find(text);
-   TokenType type = (is_in_map == keywords.end()) ? IDENTIFIER : keywords[text];
-   if (type == LOX_TRUE or type == LOX_FALSE)
-   {
-      bool literal = (type == LOX_TRUE);
-      add_token(type, literal);
-   }
-   else
-   {
-      add_token(type);
-   }
+   current = find_identifier_end(source, current);
+   add_token(keyword_type(source.substr(start, current - start)));
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "headers/ScannerBenchmark.h"
+#include "headers/Scanner.h"
+#include "headers/SourceText.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+void ScannerBenchmark::run(const std::string& path)
+{
+   std::unique_ptr<SourceText> source;
+   if (path.empty()) {
+      source = std::make_unique<SourceText>(generate(GENERATED_SIZE));
+   }
+   else {
+      source = SourceText::open(path);
+      if (source == nullptr) {
+         std::cerr << "Could not read file '" << path << "': " << std::strerror(errno) << "." << std::endl;
+         std::exit(66);
+      }
+   }
+
+   double megabytes = source->view().size() / (1024.0 * 1024.0);
+   double best = 0;
+   std::size_t token_count = 0;
+   ErrorReporter errors{std::cerr};
+   for (int i = 0; i < RUNS; ++i)
+   {
+      auto begin = std::chrono::steady_clock::now();
+      Scanner scanner(source->view(), errors);
+      token_count = scanner.scan_tokens().size();
+      std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - begin;
+      best = std::max(best, megabytes / seconds.count());
+   }
+
+   char report[160];
+   std::snprintf(report, sizeof report, "Scanned %.1f MB into %zu tokens: %.1f MB/s (best of %d runs)", megabytes, token_count, best, RUNS);
+   std::cout << report << std::endl;
+}
+
+// * Deterministic, so runs on different builds scan the same text
+std::string ScannerBenchmark::generate(std::size_t size)
+{
+   std::string text;
+   text.reserve(size + 1024);
+   for (int i = 0; text.size() < size; ++i)
+   {
+      std::string n = std::to_string(i);
+      text += "// Generated function number " + n + ", computes something useful\n";
+      text += "fun compute_value_" + n + "(first_argument, second, index) {\n";
+      text += "   var accumulator = first_argument * " + n + ".25 + second;\n";
+      text += "   if (accumulator >= 1000 and index != nil) {\n";
+      text += "      print \"accumulator for " + n + " is large\";\n";
+      text += "      return accumulator - index / 2;\n";
+      text += "   }\n";
+      text += "   while (index < 10) { index = index + 1; }\n";
+      text += "   return this_is_not_a_keyword_" + n + " or false;\n";
+      text += "}\n\n";
+   }
+   return text;
+}
\ No newline at end of file
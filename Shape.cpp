@@ -0,0 +1,22 @@
+#include "headers/Shape.h"
+
+int Shape::slot_of(const std::string& name) const
+{
+   auto elem = slots.find(name);
+   if (elem == slots.end()) { return -1; }
+   return elem->second;
+}
+
+Ref<Shape> Shape::with_field(const std::string& name)
+{
+   auto elem = transitions.find(name);
+   if (elem != transitions.end()) {
+      return elem->second;
+   }
+
+   Ref<Shape> next{new Shape()};
+   next->slots = slots;
+   next->slots[name] = slots.size();
+   transitions[name] = next;
+   return next;
+}
\ No newline at end of file
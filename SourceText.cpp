@@ -0,0 +1,106 @@
+#include "headers/SourceText.h"
+#include <cerrno>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+SourceText::SourceText(std::string a_text)
+   : owned(std::move(a_text)), text(owned)
+{}
+
+SourceText::~SourceText()
+{
+#if defined(__unix__) || defined(__APPLE__)
+   if (mapping != nullptr) {
+      munmap(mapping, mapping_size);
+   }
+#endif
+}
+
+/*
+   The mapping is private and never written, so dropping its pages loses nothing: touching them again reads them
+   back from the file. --stream calls this with what it already ran, so a long script doesn't stay resident
+*/
+void SourceText::release_before([[maybe_unused]] std::size_t offset)
+{
+#if defined(__unix__) || defined(__APPLE__)
+   if (mapping == nullptr) {
+      return;
+   }
+   std::size_t page_size = sysconf(_SC_PAGESIZE);
+   std::size_t end = offset / page_size * page_size;
+   if (end > released) {
+      madvise(static_cast<char*>(mapping) + released, end - released, MADV_DONTNEED);
+      released = end;
+   }
+#endif
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+std::unique_ptr<SourceText> SourceText::open(const std::string& path)
+{
+   int file = ::open(path.c_str(), O_RDONLY);
+   if (file < 0) {
+      return nullptr;
+   }
+   std::unique_ptr<SourceText> source{new SourceText()};
+   struct stat info;
+   if (fstat(file, &info) == 0 and S_ISREG(info.st_mode))
+   {
+      // * Empty files can't be mapped, they are just empty text
+      if (info.st_size > 0)
+      {
+         void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+         if (mapping == MAP_FAILED) {
+            int error = errno;
+            close(file);
+            errno = error;
+            return nullptr;
+         }
+         madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+         source->mapping = mapping;
+         source->mapping_size = info.st_size;
+         source->text = std::string_view(static_cast<const char*>(mapping), info.st_size);
+      }
+      close(file);
+      return source;
+   }
+
+   // * Pipes and other files without a size are read to their end
+   char buffer[64 * 1024];
+   ssize_t count;
+   while ((count = read(file, buffer, sizeof buffer)) > 0) {
+      source->owned.append(buffer, count);
+   }
+   int error = errno;
+   close(file);
+   if (count < 0) {
+      errno = error;
+      return nullptr;
+   }
+   source->text = source->owned;
+   return source;
+}
+#else
+std::unique_ptr<SourceText> SourceText::open(const std::string& path)
+{
+   std::ifstream file(path, std::ios::binary);
+   if (!file) {
+      return nullptr;
+   }
+   std::unique_ptr<SourceText> source{new SourceText()};
+   source->owned.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+   if (file.bad()) {
+      return nullptr;
+   }
+   source->text = source->owned;
+   return source;
+}
+#endif
\ No newline at end of file
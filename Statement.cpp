@@ -1,78 +1,78 @@
 #include "headers/Statement.h"
 #include "iostream"
 
-Block::Block(std::vector<std::shared_ptr<Stmt>> statements)
-    : statements{statements}
+Block::Block(std::vector<Stmt*> statements)
+    : statements{std::move(statements)}
   {}
 
-std::any Block::accept(StmtVisitor& visitor) {
-    return visitor.visit_BlockStmt(shared_from_this());
+Completion Block::accept(StmtVisitor& visitor) {
+    return visitor.visit_BlockStmt(this);
   }
 
-Expression::Expression(std::shared_ptr<Expr> expression)
+Expression::Expression(Expr* expression)
     : expression{expression}
   {}
 
-std::any Expression::accept(StmtVisitor& visitor) {
-    return visitor.visit_ExpressionStmt(shared_from_this());
+Completion Expression::accept(StmtVisitor& visitor) {
+    return visitor.visit_ExpressionStmt(this);
   }
 
-Print::Print(std::shared_ptr<Expr> expression)
+Print::Print(Expr* expression)
     : expression{expression}
   {}
 
-std::any Print::accept(StmtVisitor& visitor) {
-    return visitor.visit_PrintStmt(shared_from_this());
+Completion Print::accept(StmtVisitor& visitor) {
+    return visitor.visit_PrintStmt(this);
   }
 
-Var::Var(Token name, std::shared_ptr<Expr> initializer)
+Var::Var(const Token& name, Expr* initializer)
     : name{name}, initializer{initializer}
   {}
 
-std::any Var::accept(StmtVisitor& visitor) {
-    return visitor.visit_VarStmt(shared_from_this());
+Completion Var::accept(StmtVisitor& visitor) {
+    return visitor.visit_VarStmt(this);
   }
 
-If::If(std::shared_ptr<Expr> condition, std::shared_ptr<Stmt> then_branch, std::shared_ptr<Stmt> else_branch)
-    : condition(condition), then_branch(then_branch), else_branch(else_branch) 
+If::If(const Token& keyword, Expr* condition, Stmt* then_branch, Stmt* else_branch)
+    : keyword(keyword), condition(condition), then_branch(then_branch), else_branch(else_branch) 
  {}
 
-std::any If::accept(StmtVisitor& visitor){
-  return visitor.visit_IfStmt(shared_from_this()); 
+Completion If::accept(StmtVisitor& visitor){
+  return visitor.visit_IfStmt(this); 
 }
 
-While::While(std::shared_ptr<Expr> condition, std::shared_ptr<Stmt> body)
-    : condition(condition), body(body)
+While::While(const Token& keyword, Expr* condition, Stmt* body)
+    : keyword(keyword), condition(condition), body(body)
   {}
 
-std::any While::accept(StmtVisitor& visitor)
+Completion While::accept(StmtVisitor& visitor)
 {
-  return visitor.visit_WhileStmt(shared_from_this());
+  return visitor.visit_WhileStmt(this);
 }
 
-Function::Function(Token name, std::vector<Token> params, std::vector<std::shared_ptr<Stmt>> body)
-  : name(name), params(params), body(body)
+Function::Function(const Token& name, std::vector<const Token*> params, std::vector<Stmt*> body)
+  : name(name), params(std::move(params)), body(std::move(body))
 { }
 
-std::any Function::accept(StmtVisitor& visitor)
+Completion Function::accept(StmtVisitor& visitor)
 {
-  return visitor.visit_FunctionStmt(shared_from_this());
+  return visitor.visit_FunctionStmt(this);
 }
 
-Return::Return(Token keyword, std::shared_ptr<Expr> value)
+Return::Return(const Token& keyword, Expr* value)
   : keyword(keyword), value(value)
 { }
 
-std::any Return::accept(StmtVisitor& visitor)
+Completion Return::accept(StmtVisitor& visitor)
 {
-  return visitor.visit_ReturnStmt(shared_from_this());
+  return visitor.visit_ReturnStmt(this);
 }
 
-Class::Class(Token name, std::shared_ptr<Variable> superclass, std::vector<std::shared_ptr<Function>> methods)
-  : name(name), superclass(superclass), methods(methods)
+Class::Class(const Token& name, Variable* superclass, std::vector<Function*> methods)
+  : name(name), superclass(superclass), methods(std::move(methods))
 {}
 
-std::any Class::accept(StmtVisitor& visitor)
+Completion Class::accept(StmtVisitor& visitor)
 {
-  return visitor.visit_ClassStmt(shared_from_this());
+  return visitor.visit_ClassStmt(this);
 }
@@ -1,11 +1,11 @@
 #include "headers/Token.h"
 
 
-Token::Token(TokenType a_type, std::string a_lexeme, std::any a_literal, int a_line)
+Token::Token(TokenType a_type, std::string_view a_lexeme, int a_line, double a_number)
 :  type(a_type),
+   line(a_line),
    lexeme(a_lexeme),
-   literal(a_literal),
-   line(a_line)
+   number(a_number)
 { }
 
 
@@ -36,18 +36,18 @@ std::string Token::to_string() const
         literal_text = lexeme;
         break;
       case (STRING):
-        literal_text = std::any_cast<std::string>(literal);
+        literal_text = string_value();
         break;
       case (NUMBER):
-        literal_text = std::to_string(std::any_cast<double>(literal));
+        literal_text = std::to_string(number);
         break;
       case (LOX_TRUE):
       case (LOX_FALSE):
-        literal_text = std::to_string(std::any_cast<bool>(literal));
+        literal_text = std::to_string(type == LOX_TRUE);
         break;
       default:
         literal_text = "not_literal";
     }
 
-   return token_to_string(type) + " " + lexeme + " " + literal_text;
+   return token_to_string(type) + " " + std::string(lexeme) + " " + literal_text;
 }
\ No newline at end of file
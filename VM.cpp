@@ -0,0 +1,523 @@
+#include "headers/VM.h"
+#include "headers/Natives.h"
+#include "headers/RuntimeError.h"
+#include <cstdlib>
+#include <iostream>
+
+// * The stack comes zeroed from calloc, all zero bytes is a nil Value, and pages nothing ever reached are never touched
+VM::VM(std::ostream& out, ErrorReporter& errors, Heap& heap)
+   : out(out), errors(errors), heap(heap), stack(static_cast<Value*>(std::calloc(STACK_MAX, sizeof(Value)))), stack_top(stack)
+{
+   frames.reserve(FRAMES_MAX);
+   define_global("clock", Ref<NativeFunction>{new NativeClock()});
+}
+
+VM::~VM()
+{
+   reset_stack();
+   std::free(stack);
+}
+
+void VM::interpret(VMFunction* script)
+{
+   Ref<VMClosure> closure{new VMClosure(script)};
+   push(closure);
+   frames.push_back(CallFrame{closure, script->chunk.code.data(), stack, stack});
+
+   try {
+      run();
+   } catch (RuntimeError const& error) {
+      reset_stack();
+      errors.runtime_error(error);
+   }
+}
+
+int VM::global_slot(const std::string& name)
+{
+   auto elem = global_slots.find(name);
+   if (elem != global_slots.end()) {
+      return elem->second;
+   }
+
+   globals.emplace_back();
+   global_slots[name] = globals.size() - 1;
+   return globals.size() - 1;
+}
+
+void VM::define_global(const std::string& name, Value value)
+{
+   Global& global = globals[global_slot(name)];
+   global.value = std::move(value);
+   global.defined = true;
+}
+
+static int read_short(const std::uint8_t*& ip)
+{
+   int value = (ip[0] << 8) | ip[1];
+   ip += 2;
+   return value;
+}
+
+static int read_index(const std::uint8_t*& ip)
+{
+   int value = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+   ip += 3;
+   return value;
+}
+
+void VM::run()
+{
+   CallFrame* frame;
+   Chunk* chunk;
+   const std::uint8_t* ip;
+   Value* slots;
+
+   // * The frame's ip is only written back when it is about to change frames
+   auto load_frame = [&]() {
+      frame = &frames.back();
+      chunk = &frame->closure->function->chunk;
+      ip = frame->ip;
+      slots = frame->slots;
+   };
+   // * The token of the instruction being executed, all bytes of an instruction share it
+   auto token = [&]() -> const Token& {
+      return *chunk->tokens[ip - chunk->code.data() - 1];
+   };
+
+   load_frame();
+   while (true)
+   {
+      switch (static_cast<OpCode>(*ip++))
+      {
+         case OpCode::CONSTANT:
+            push(chunk->constants[read_index(ip)]);
+            break;
+         case OpCode::NIL:       push(nullptr); break;
+         case OpCode::LOX_TRUE:  push(true);    break;
+         case OpCode::LOX_FALSE: push(false);   break;
+         case OpCode::POP:       pop();         break;
+
+         case OpCode::GET_LOCAL:
+            push(slots[*ip++]);
+            break;
+         case OpCode::SET_LOCAL:
+            slots[*ip++] = stack_top[-1];
+            break;
+
+         case OpCode::GET_GLOBAL: {
+            Global& global = globals[read_index(ip)];
+            if (!global.defined) {
+               throw RuntimeError(token(), "Undefined variable '" + std::string(token().lexeme) + "'.");
+            }
+            push(global.value);
+            break;
+         }
+         case OpCode::SET_GLOBAL: {
+            Global& global = globals[read_index(ip)];
+            if (!global.defined) {
+               throw RuntimeError(token(), "Undefined variable '" + std::string(token().lexeme) + "'.");
+            }
+            global.value = stack_top[-1];
+            break;
+         }
+         case OpCode::DEFINE_GLOBAL: {
+            Global& global = globals[read_index(ip)];
+            global.value = pop();
+            global.defined = true;
+            break;
+         }
+
+         case OpCode::GET_UPVALUE:
+            push(*frame->closure->upvalues[read_index(ip)]->location);
+            break;
+         case OpCode::SET_UPVALUE:
+            *frame->closure->upvalues[read_index(ip)]->location = stack_top[-1];
+            break;
+
+         case OpCode::GET_PROPERTY: {
+            VMPropertyCache& cache = chunk->caches[read_index(ip)];
+            Value& object = stack_top[-1];
+            if (!object.is_instance()) {
+               throw RuntimeError(token(), "Only instances have properties.");
+            }
+            object = object.as<VMInstance>()->get(token(), cache);
+            break;
+         }
+         case OpCode::SET_PROPERTY: {
+            VMPropertyCache& cache = chunk->caches[read_index(ip)];
+            Value value = pop();
+            Value& object = stack_top[-1];
+            if (!object.is_instance()) {
+               throw RuntimeError(token(), "Only instances have fields.");
+            }
+            object.as<VMInstance>()->set(token(), value, cache);
+            object = std::move(value);
+            break;
+         }
+         case OpCode::CHECK_INSTANCE:
+            if (!stack_top[-1].is_instance()) {
+               throw RuntimeError(token(), "Only instances have fields.");
+            }
+            break;
+         case OpCode::GET_METHOD: {
+            VMPropertyCache& cache = chunk->caches[read_index(ip)];
+            Value& object = stack_top[-1];
+            if (!object.is_instance()) {
+               throw RuntimeError(token(), "Only instances have properties.");
+            }
+
+            VMClosure* method = object.as<VMInstance>()->find_method(token().lexeme, cache);
+            if (method != nullptr) {
+               Value receiver = std::move(object);
+               object = Ref<VMClosure>(method);
+               push(std::move(receiver));
+            }
+            else {
+               Value property = object.as<VMInstance>()->get(token(), cache);
+               object = nullptr;
+               push(std::move(property));
+            }
+            break;
+         }
+         case OpCode::GET_SUPER: {
+            VMPropertyCache& cache = chunk->caches[read_index(ip)];
+            Value superclass = pop();
+            VMClosure* method = superclass.as<VMClass>()->find_method(token().lexeme, cache);
+            if (method == nullptr) {
+               throw RuntimeError(token(), "Undefined property '" + std::string(token().lexeme) + "'.");
+            }
+            stack_top[-1] = method->bind(stack_top[-1]);
+            break;
+         }
+         case OpCode::SUPER_METHOD: {
+            VMPropertyCache& cache = chunk->caches[read_index(ip)];
+            Value superclass = pop();
+            VMClosure* method = superclass.as<VMClass>()->find_method(token().lexeme, cache);
+            if (method == nullptr) {
+               throw RuntimeError(token(), "Undefined property '" + std::string(token().lexeme) + "'.");
+            }
+            Value receiver = std::move(stack_top[-1]);
+            stack_top[-1] = Ref<VMClosure>(method);
+            push(std::move(receiver));
+            break;
+         }
+
+         // * Binary operands sit as [right, left], numbers need no releasing so their slot is just dropped
+         case OpCode::EQUAL: {
+            Value left = pop();
+            stack_top[-1] = left.equals(stack_top[-1]);
+            break;
+         }
+         case OpCode::NOT_EQUAL: {
+            Value left = pop();
+            stack_top[-1] = !left.equals(stack_top[-1]);
+            break;
+         }
+         case OpCode::GREATER: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (!left.is_number() or !right.is_number()) { throw RuntimeError(token(), "Operand must be a number."); }
+            right = left.as_number() > right.as_number();
+            --stack_top;
+            break;
+         }
+         case OpCode::GREATER_EQUAL: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (!left.is_number() or !right.is_number()) { throw RuntimeError(token(), "Operand must be a number."); }
+            right = left.as_number() >= right.as_number();
+            --stack_top;
+            break;
+         }
+         case OpCode::LESS: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (!left.is_number() or !right.is_number()) { throw RuntimeError(token(), "Operand must be a number."); }
+            right = left.as_number() < right.as_number();
+            --stack_top;
+            break;
+         }
+         case OpCode::LESS_EQUAL: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (!left.is_number() or !right.is_number()) { throw RuntimeError(token(), "Operand must be a number."); }
+            right = left.as_number() <= right.as_number();
+            --stack_top;
+            break;
+         }
+         case OpCode::ADD: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (left.is_number() and right.is_number()) {
+               right = left.as_number() + right.as_number();
+               --stack_top;
+            }
+            else if (left.is_string() and right.is_string()) {
+               right = left.as_string() + right.as_string();
+               pop();
+            }
+            else {
+               throw RuntimeError(token(), "Operands must be two numbers or two strings.");
+            }
+            break;
+         }
+         case OpCode::SUBTRACT: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (!left.is_number() or !right.is_number()) { throw RuntimeError(token(), "Operand must be a number."); }
+            right = left.as_number() - right.as_number();
+            --stack_top;
+            break;
+         }
+         case OpCode::MULTIPLY: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (!left.is_number() or !right.is_number()) { throw RuntimeError(token(), "Operand must be a number."); }
+            right = left.as_number() * right.as_number();
+            --stack_top;
+            break;
+         }
+         case OpCode::DIVIDE: {
+            Value& left = stack_top[-1];
+            Value& right = stack_top[-2];
+            if (!left.is_number() or !right.is_number()) { throw RuntimeError(token(), "Operand must be a number."); }
+            right = left.as_number() / right.as_number();
+            --stack_top;
+            break;
+         }
+         case OpCode::NOT:
+            stack_top[-1] = !stack_top[-1].is_truthy();
+            break;
+         case OpCode::NEGATE:
+            if (!stack_top[-1].is_number()) {
+               throw RuntimeError(token(), "Operand must be a number.");
+            }
+            stack_top[-1] = -stack_top[-1].as_number();
+            break;
+
+         case OpCode::PRINT:
+            out << pop().to_string() << "\n";
+            break;
+
+         case OpCode::JUMP: {
+            int offset = read_short(ip);
+            ip += offset;
+            break;
+         }
+         case OpCode::JUMP_IF_FALSE: {
+            int offset = read_short(ip);
+            if (!pop().is_truthy()) { ip += offset; }
+            break;
+         }
+         case OpCode::JUMP_IF_FALSE_OR_POP: {
+            int offset = read_short(ip);
+            if (!stack_top[-1].is_truthy()) { ip += offset; }
+            else { pop(); }
+            break;
+         }
+         case OpCode::JUMP_IF_TRUE_OR_POP: {
+            int offset = read_short(ip);
+            if (stack_top[-1].is_truthy()) { ip += offset; }
+            else { pop(); }
+            break;
+         }
+         case OpCode::LOOP: {
+            int offset = read_short(ip);
+            ip -= offset;
+            if (heap.collection_due()) {
+               heap.collect(); }
+            break;
+         }
+
+         case OpCode::CALL: {
+            int argument_count = *ip++;
+            frame->ip = ip;
+            Value* callee = stack_top - argument_count - 1;
+            call_value(callee, argument_count, callee, token());
+            load_frame();
+            break;
+         }
+         // * A method found by GET_METHOD or SUPER_METHOD sits below its receiver, a nil there means an ordinary callee follows
+         case OpCode::CALL_METHOD: {
+            int argument_count = *ip++;
+            frame->ip = ip;
+            Value* method = stack_top - argument_count - 2;
+            if (method->is_nil()) {
+               call_value(method + 1, argument_count, method, token());
+            }
+            else {
+               call_closure(method->as<VMClosure>(), method + 1, argument_count, method, token());
+            }
+            load_frame();
+            break;
+         }
+
+         case OpCode::CLOSURE: {
+            VMFunction* function = chunk->functions[read_index(ip)];
+            Ref<VMClosure> closure{new VMClosure(function)};
+            closure->upvalues.reserve(function->upvalues.size());
+            for (const UpvalueSource& source : function->upvalues)
+            {
+               if (source.is_local) {
+                  closure->upvalues.push_back(capture_upvalue(slots + source.index));
+               }
+               else {
+                  closure->upvalues.push_back(frame->closure->upvalues[source.index]);
+               }
+            }
+            push(std::move(closure));
+            break;
+         }
+         case OpCode::CLOSE_UPVALUE:
+            close_upvalues(stack_top - 1);
+            pop();
+            break;
+
+         case OpCode::RETURN: {
+            Value result = pop();
+            close_upvalues(slots);
+            Value* stack_base = frame->stack_base;
+            frames.pop_back();
+            pop_to(stack_base);
+            if (frames.empty()) {
+               return;
+            }
+
+            push(std::move(result));
+            load_frame();
+            break;
+         }
+
+         case OpCode::CLASS: {
+            const std::string& name = chunk->constants[read_index(ip)].as_string();
+            bool has_superclass = *ip++;
+            Ref<VMClass> vm_class{new VMClass(name)};
+            if (has_superclass) {
+               Value& superclass = stack_top[-1];
+               if (!superclass.is_class()) {
+                  throw RuntimeError(token(), "Superclass must be a class.");
+               }
+               vm_class->inherit(superclass.as<VMClass>());
+               superclass = vm_class;
+            }
+            else {
+               push(vm_class);
+            }
+            break;
+         }
+         case OpCode::METHOD: {
+            Value method = pop();
+            stack_top[-1].as<VMClass>()->add_method(std::string(token().lexeme), method.as<VMClosure>());
+            break;
+         }
+      }
+   }
+}
+
+// * Bound methods and classes replace the callee with the receiver, so slot 0 of the frame is "this"
+void VM::call_value(Value* callee, int argument_count, Value* stack_base, const Token& token)
+{
+   switch (callee->type())
+   {
+      case ValueType::FUNCTION: {
+         Ref<VMClosure> closure = callee->as<VMClosure>();
+         if (!closure->receiver.is_nil()) {
+            *callee = closure->receiver;
+         }
+         call_closure(std::move(closure), callee, argument_count, stack_base, token);
+         return;
+      }
+      case ValueType::CLASS: {
+         VMClass* vm_class = callee->as<VMClass>();
+         Ref<VMClosure> initializer = vm_class->initializer;
+         Value instance = Ref<VMInstance>{new VMInstance(Ref<VMClass>(vm_class))};
+         *callee = instance;
+         if (initializer != nullptr) {
+            call_closure(std::move(initializer), callee, argument_count, stack_base, token);
+            return;
+         }
+
+         if (argument_count != 0) {
+            throw RuntimeError{token, "Expected 0 arguments but got " + std::to_string(argument_count) + "."};
+         }
+         pop_to(stack_base);
+         push(std::move(instance));
+         return;
+      }
+      case ValueType::NATIVE: {
+         Value result = call_native(callee, argument_count, token);
+         pop_to(stack_base);
+         push(std::move(result));
+         return;
+      }
+      default:
+         throw RuntimeError{token, "Can only call functions and classes."};
+   }
+}
+
+void VM::call_closure(Ref<VMClosure> closure, Value* slots, int argument_count, Value* stack_base, const Token& token)
+{
+   int arity = closure->function->arity;
+   if (argument_count != arity) {
+      throw RuntimeError{token, "Expected " + std::to_string(arity) + " arguments but got " + std::to_string(argument_count) + "."};
+   }
+   if (static_cast<int>(frames.size()) == FRAMES_MAX or stack + STACK_MAX - stack_top < FRAME_SLOTS) {
+      throw RuntimeError{token, "Stack overflow."};
+   }
+
+   const std::uint8_t* code = closure->function->chunk.code.data();
+   frames.push_back(CallFrame{std::move(closure), code, slots, stack_base});
+   // * Everything the running code uses is on the stack, in a frame or a global, which all count their references
+   if (heap.collection_due()) {
+      heap.collect(); }
+}
+
+Value VM::call_native(Value* callee, int argument_count, const Token& token)
+{
+   NativeFunction* native = callee->as<NativeFunction>();
+   if (argument_count != native->arity()) {
+      throw RuntimeError{token, "Expected " + std::to_string(native->arity()) + " arguments but got " + std::to_string(argument_count) + "."};
+   }
+
+   std::vector<Value> arguments(callee + 1, callee + 1 + argument_count);
+   return native->run(arguments);
+}
+
+// * Closures capturing the same variable share one upvalue
+Ref<VMUpvalue> VM::capture_upvalue(Value* local)
+{
+   int i = open_upvalues.size();
+   while (i > 0 and open_upvalues[i - 1]->location > local) {
+      --i;
+   }
+   if (i > 0 and open_upvalues[i - 1]->location == local) {
+      return open_upvalues[i - 1];
+   }
+
+   Ref<VMUpvalue> upvalue{new VMUpvalue(local)};
+   open_upvalues.insert(open_upvalues.begin() + i, upvalue);
+   return upvalue;
+}
+
+void VM::close_upvalues(Value* last)
+{
+   while (!open_upvalues.empty() and open_upvalues.back()->location >= last) {
+      open_upvalues.back()->close();
+      open_upvalues.pop_back();
+   }
+}
+
+// * Popping releases the values, the slots are left nil
+void VM::pop_to(Value* base)
+{
+   while (stack_top > base) {
+      pop();
+   }
+}
+
+void VM::reset_stack()
+{
+   close_upvalues(stack);
+   frames.clear();
+   pop_to(stack);
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "headers/VMObjects.h"
+#include "headers/RuntimeError.h"
+
+VMClosure::VMClosure(VMFunction* function, Value receiver)
+   : function(function), receiver(receiver)
+{
+   track();
+}
+
+void VMClosure::trace(Tracer& tracer)
+{
+   for (const Ref<VMUpvalue>& upvalue : upvalues) {
+      tracer.visit(upvalue.get());
+   }
+   tracer.visit(receiver);
+}
+
+void VMClosure::clear_references()
+{
+   upvalues.clear();
+   receiver = nullptr;
+}
+
+std::string VMClosure::to_string()
+{
+   return "<fn " + function->name + ">";
+}
+
+// * Only needed when a method is used as a value, calls like instance.method() run the method directly
+Ref<VMClosure> VMClosure::bind(Value instance)
+{
+   Ref<VMClosure> bound{new VMClosure(function, instance)};
+   bound->upvalues = upvalues;
+   return bound;
+}
+
+VMClass::VMClass(std::string name)
+   : name(std::move(name))
+{
+   track();
+}
+
+void VMClass::trace(Tracer& tracer)
+{
+   tracer.visit(initializer.get());
+   for (const auto& [method_name, method] : methods) {
+      tracer.visit(method.get());
+   }
+}
+
+void VMClass::clear_references()
+{
+   initializer = nullptr;
+   methods.clear();
+}
+
+// * Runs before the class's own methods are added, so they override what it inherits
+void VMClass::inherit(VMClass* superclass)
+{
+   methods = superclass->methods;
+   initializer = superclass->initializer;
+}
+
+void VMClass::add_method(const std::string& method_name, Ref<VMClosure> method)
+{
+   if (method_name == "init") {
+      initializer = method;
+   }
+   methods[method_name] = std::move(method);
+}
+
+VMClosure* VMClass::find_method(const std::string& method_name)
+{
+   auto elem = methods.find(method_name);
+   if (elem == methods.end()) {
+      return nullptr;
+   }
+   return elem->second.get();
+}
+
+VMClosure* VMClass::find_method(std::string_view name, VMPropertyCache& cache)
+{
+   if (const VMPropertyCache::Entry* entry = cache.find(instance_shape.get())) {
+      return entry->method;
+   }
+   VMPropertyCache::Entry miss;
+   miss.shape = instance_shape;
+   miss.method = find_method(std::string(name));
+   cache.add(miss);
+   return miss.method;
+}
+
+int VMClass::arity()
+{
+   if (initializer == nullptr) {
+      return 0;
+   }
+   return initializer->function->arity;
+}
+
+VMInstance::VMInstance(Ref<VMClass> vm_class)
+   : vm_class(vm_class), shape(vm_class->instance_shape), fields(SpareVectors<Value>::take())
+{
+   track();
+}
+
+VMInstance::~VMInstance()
+{
+   SpareVectors<Value>::give_back(fields);
+}
+
+void VMInstance::trace(Tracer& tracer)
+{
+   tracer.visit(vm_class.get());
+   for (const Value& field : fields) {
+      tracer.visit(field);
+   }
+}
+
+void VMInstance::clear_references()
+{
+   vm_class = nullptr;
+   fields.clear();
+}
+
+std::string VMInstance::to_string()
+{
+   return vm_class->name + " instance";
+}
+
+Value VMInstance::get(const Token& name, VMPropertyCache& cache)
+{
+   VMPropertyCache::Entry miss;
+   const VMPropertyCache::Entry& entry = lookup(name.lexeme, cache, miss);
+   if (entry.slot >= 0) {
+      return fields[entry.slot];
+   }
+
+   if (entry.method != nullptr) {
+      return entry.method->bind( Value(Ref<VMInstance>(this)) );
+   }
+
+   throw RuntimeError(name, "Undefined property '" + std::string(name.lexeme) + "'.");
+}
+
+// * The method a call like instance.name() runs, unless a field with the same name shadows it
+VMClosure* VMInstance::find_method(std::string_view name, VMPropertyCache& cache)
+{
+   VMPropertyCache::Entry miss;
+   const VMPropertyCache::Entry& entry = lookup(name, cache, miss);
+   if (entry.slot >= 0) {
+      return nullptr;
+   }
+   return entry.method;
+}
+
+void VMInstance::set(const Token& name, Value value, VMPropertyCache& cache)
+{
+   VMPropertyCache::Entry miss;
+   const VMPropertyCache::Entry* entry = cache.find(shape.get());
+   if (entry == nullptr)
+   {
+      std::string key{name.lexeme};
+      miss.shape = shape;
+      miss.slot = shape->slot_of(key);
+      if (miss.slot < 0) {
+         miss.transition = shape->with_field(key);
+         miss.slot = fields.size();
+      }
+      cache.add(miss);
+      entry = &miss;
+   }
+
+   if (entry->transition != nullptr) {
+      shape = entry->transition;
+      fields.push_back(std::move(value));
+   }
+   else {
+      fields[entry->slot] = std::move(value);
+   }
+}
+
+const VMPropertyCache::Entry& VMInstance::lookup(std::string_view name, VMPropertyCache& cache, VMPropertyCache::Entry& miss)
+{
+   if (const VMPropertyCache::Entry* entry = cache.find(shape.get())) {
+      return *entry;
+   }
+
+   std::string key{name};
+   miss.shape = shape;
+   miss.slot = shape->slot_of(key);
+   if (miss.slot < 0) {
+      miss.method = vm_class->find_method(key);
+   }
+   cache.add(miss);
+   return miss;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "headers/Value.h"
+
+// * All objects that are not nill or false are truthy *
+bool Value::is_truthy() const
+{
+   if (tag == ValueType::NIL) { return false; }
+   if (tag == ValueType::BOOL) { return bits != 0; }
+   return true;
+}
+
+bool Value::equals(const Value& other) const
+{
+   if (tag != other.tag) { return false; }
+
+   switch (tag)
+   {
+      case ValueType::NIL:    return true;
+      case ValueType::BOOL:   return bits == other.bits;
+      case ValueType::NUMBER: return number == other.number;
+      case ValueType::STRING: return as_string() == other.as_string();
+      default:                return object == other.object; // * Functions, classes and instances compare by identity
+   }
+}
+
+std::string Value::to_string() const
+{
+   switch (tag)
+   {
+      case ValueType::NIL: 
+         return "nil";
+      case ValueType::BOOL: 
+         return bits != 0 ? "true" : "false";
+      case ValueType::NUMBER: {
+         std::string text = std::to_string(number);
+         if (text[text.length() - 2] == '.' && text[text.length() - 1] == '0') {
+            text = text.substr(0, text.length() - 2);
+         }
+         return text;
+      }
+      case ValueType::STRING: 
+         return as_string();
+      case ValueType::NATIVE:
+      case ValueType::FUNCTION:
+      case ValueType::CLASS:
+      case ValueType::INSTANCE:
+         return object->to_string();
+   }
+
+   return "Error in stringify: object type not recognized.";
+}
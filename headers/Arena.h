@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+   Bump allocator for AST nodes: nodes are placed one after another in large blocks and all freed together
+   when the arena goes away, destructors run in reverse order of construction
+*/
+class Arena {
+public:
+   Arena() = default;
+   Arena(const Arena&) = delete;
+   Arena& operator=(const Arena&) = delete;
+   ~Arena();
+
+   void absorb(Arena& other); // * Takes over other's nodes, they are freed with this arena instead
+
+   template <typename T, typename... Args>
+   T* make(Args&&... args)
+   {
+      T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+      if constexpr (!std::is_trivially_destructible_v<T>) {
+         destructors.push_back({object, [](void* ptr) { static_cast<T*>(ptr)->~T(); }});
+      }
+      return object;
+   }
+
+private:
+   static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+   struct Destructor {
+      void* object;
+      void (*destroy)(void*);
+   };
+
+   std::vector<std::unique_ptr<std::byte[]>> blocks;
+   std::vector<Destructor> destructors;
+   std::size_t offset = BLOCK_SIZE;  // * Starts "full" so the first allocation opens a block
+   std::size_t capacity = BLOCK_SIZE;
+
+   void* allocate(std::size_t size, std::size_t alignment);
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+/*
+   Emits the handful of x86-64 instructions the JIT needs, into a byte buffer
+   Values are doubles: xmm0 holds the result of an expression, xmm1 is scratch.
+   rbp addresses the frame's slots, rbx holds the JitContext and temporaries are pushed to the machine stack
+*/
+class Assembler {
+public:
+   // * A jump target, jumps emitted before it is bound are patched when it is
+   struct Label {
+      int position = -1;
+      std::vector<int> patches;
+   };
+
+   // * Condition codes as used by jcc
+   enum Condition : std::uint8_t {
+      BELOW = 0x2, ABOVE_EQUAL = 0x3, EQUAL = 0x4, NOT_EQUAL = 0x5,
+      BELOW_EQUAL = 0x6, ABOVE = 0x7, PARITY = 0xA
+   };
+
+   std::vector<std::uint8_t> code;
+
+   void prologue();
+   void epilogue();
+   void set_frame_size(int slot_count); // * Patches the prologue once the number of slots is known
+   void load_argument(int index);   // * xmm0 = the index-th double of the array in rsi
+   void load_slot(int slot);        // * xmm0 = slot
+   void store_slot(int slot);       // * slot = xmm0
+   void load_constant(double value);
+   void push();                     // * Pushes xmm0
+   void pop_operands();             // * xmm1 = xmm0, then pops into xmm0
+   void add();
+   void subtract();
+   void multiply();
+   void divide();
+   void negate();
+   void compare(bool swapped);      // * ucomisd xmm0, xmm1 (or xmm1, xmm0)
+   void grow_stack(int bytes);
+   void shrink_stack(int bytes);
+   void call(const void* function, const void* argument); // * function(rbx, argument, rsp)
+   void jump_if_flag(int offset, Label& label);
+
+   void jump(Label& label);
+   void jump_if(Condition condition, Label& label);
+   void bind(Label& label);
+
+private:
+   int frame_size_position = -1;
+
+   void emit(std::initializer_list<std::uint8_t> bytes);
+   void emit32(std::int32_t value);
+   void emit64(std::uint64_t value);
+   void emit_target(Label& label);
+   void sse(std::uint8_t prefix, std::uint8_t opcode); // * <prefix> 0F <opcode> xmm0, xmm1
+   static std::int32_t slot_offset(int slot);
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Expr.h"
+#include "Statement.h"
+#include "Resolver.h"
+
+// * The runtime every emitted program starts with, in CRuntime.cpp
+extern const char* const C_RUNTIME;
+
+/*
+   Translates a resolved program into one self-contained C++17 translation unit (--emit-c)
+   Expressions become calls into the runtime in C_RUNTIME, which reproduces the interpreter's values,
+   error messages and formatting; functions become lambdas and globals become C++ globals.
+   Locals are plain C++ variables unless a nested function uses them: those live in a shared cell the lambdas capture.
+   Which locals are captured is only known once their scope was walked, so the program is walked twice:
+   the first walk only marks captured locals, the second writes the code.
+   Both walks declare locals in the order the Resolver did, so a Resolution indexes the same scopes here
+*/
+class CEmitter : ExprVisitor, StmtVisitor {
+public:
+   Value visit_BinaryExpr  (Binary* expr)   override;
+   Value visit_GroupExpr   (Group* expr)    override;
+   Value visit_LiteralExpr (Literal* expr)  override;
+   Value visit_UnaryExpr   (Unary* expr)    override;
+   Value visit_VariableExpr(Variable* expr) override;
+   Value visit_AssignExpr  (Assign* expr)   override;
+   Value visit_LogicalExpr (Logical* expr)  override;
+   Value visit_CallExpr    (Call* expr)     override;
+   Value visit_GetExpr     (Get* expr)      override;
+   Value visit_SetExpr     (Set* expr)      override;
+   Value visit_ThisExpr    (This* expr)     override;
+   Value visit_SuperExpr   (Super* expr)    override;
+   Completion visit_ExpressionStmt (Expression* stmt) override;
+   Completion visit_PrintStmt      (Print* stmt)      override;
+   Completion visit_VarStmt        (Var* stmt)        override;
+   Completion visit_BlockStmt      (Block* stmt)      override;
+   Completion visit_IfStmt         (If* stmt)         override;
+   Completion visit_WhileStmt      (While* stmt)      override;
+   Completion visit_FunctionStmt   (Function* stmt)   override;
+   Completion visit_ReturnStmt     (Return* stmt)     override;
+   Completion visit_ClassStmt      (Class* stmt)      override;
+
+   std::string emit(const std::vector<Stmt*>& statements);
+private:
+   struct Local {
+      std::string name; // * The C++ name, unique in the whole program
+      int function;     // * The function that declared it
+   };
+
+   std::vector<Local> locals;             // * Indexed by declaration order
+   std::vector<bool> captured;            // * Same indices, filled during the first walk
+   std::vector<std::vector<int>> scopes;  // * Indices into locals, mirroring the Resolver's scopes
+   int function = 0;                      // * The function being walked, 0 is the top level
+   int function_count = 0;
+   FunctionType function_type = FunctionType::NONE;
+
+   std::set<std::string> globals;
+   std::vector<std::string> constants;    // * Definitions of the string literals
+   std::ostringstream out;
+   int indent = 1;
+   std::string expr_result;               // * The visitors leave the C++ expression they built here
+private:
+   void walk(const std::vector<Stmt*>& statements);
+   std::string emit(Expr* expr);
+   void emit(Stmt* stmt);
+   std::ostream& line();
+   int declare(std::string_view name);
+   std::string declaration(int local, const std::string& value);
+   std::string access(const Resolution& resolution);
+   std::string access(int local);
+   std::string global(const Token& name);
+   std::string function_value(Function* function, FunctionType type);
+   std::string number(double value);
+   std::string string_constant(const std::string& value);
+};
\ No newline at end of file
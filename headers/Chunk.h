@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Token.h"
+#include "Value.h"
+#include "Shape.h"
+
+class VMClosure;
+struct VMFunction;
+
+using VMPropertyCache = BasicPropertyCache<VMClosure>;
+
+/*
+   The VM's instructions, operands follow the opcode byte
+   Global indices, constants, caches, functions and upvalues are three byte operands (high byte first), jump offsets two bytes,
+   local slots and argument counts one byte. Instructions on properties take the property name from their token
+*/
+enum class OpCode : std::uint8_t {
+   CONSTANT,                    // constant
+   NIL, LOX_TRUE, LOX_FALSE,
+   POP,
+   GET_LOCAL, SET_LOCAL,        // local slot
+   GET_GLOBAL, SET_GLOBAL,      // global index
+   DEFINE_GLOBAL,               // global index
+   GET_UPVALUE, SET_UPVALUE,    // upvalue index
+   GET_PROPERTY,                // cache:  [object] -> [value]
+   SET_PROPERTY,                // cache:  [object, value] -> [value]
+   CHECK_INSTANCE,              //         [object] -> [object], fails like SET_PROPERTY would
+   GET_METHOD,                  // cache:  [object] -> [method, object], or [nil, property] when no method is found
+   GET_SUPER,                   // cache:  [this, superclass] -> [bound method]
+   SUPER_METHOD,                // cache:  [this, superclass] -> [method, this]
+   EQUAL, NOT_EQUAL,
+   GREATER, GREATER_EQUAL, LESS, LESS_EQUAL,
+   ADD, SUBTRACT, MULTIPLY, DIVIDE,   // [right, left] -> [result], the right operand is evaluated first
+   NOT, NEGATE,
+   PRINT,
+   JUMP, JUMP_IF_FALSE,         // forward offset, JUMP_IF_FALSE pops the condition
+   JUMP_IF_FALSE_OR_POP,        // forward offset, keeps the condition when jumping (and)
+   JUMP_IF_TRUE_OR_POP,         // forward offset, keeps the condition when jumping (or)
+   LOOP,                        // backward offset
+   CALL,                        // argument count: [callee, arguments...] -> [result]
+   CALL_METHOD,                 // argument count: what GET_METHOD or SUPER_METHOD left, then the arguments
+   CLOSURE,                     // function: index into the chunk's functions
+   CLOSE_UPVALUE,
+   RETURN,
+   CLASS,                       // name constant, 1 if the superclass is on the stack
+   METHOD                       // [class, closure] -> [class], the method name is the token
+};
+
+constexpr int MAX_INDEX = 0xffffff; // * The largest three byte operand
+
+/*
+   Bytecode of one function
+   Every byte remembers the token it was compiled from, runtime errors are reported at that token
+*/
+struct Chunk {
+   std::vector<std::uint8_t> code;
+   std::vector<const Token*> tokens;
+   std::vector<Value> constants;
+   std::vector<VMFunction*> functions; // * The functions declared directly in this one
+   std::vector<VMPropertyCache> caches; // * One for every property access site, super.name ones included
+
+   void write(std::uint8_t byte, const Token* token);
+   int add_constant(Value value); // * Equal numbers and strings share one constant
+   int add_cache();
+private:
+   std::unordered_map<std::uint64_t, int> number_constants; // * By their bits, so 0 and -0 stay apart
+   std::unordered_map<std::string_view, int> string_constants; // * Point into the constants
+};
+
+// * Where a new closure takes an upvalue from: a local slot of the enclosing function or an upvalue of the enclosing closure
+struct UpvalueSource {
+   bool is_local;
+   int index;
+};
+
+// * A function compiled to bytecode. Compiled functions belong to the Program they were compiled from
+struct VMFunction {
+   std::string name;
+   int arity = 0;
+   std::vector<UpvalueSource> upvalues;
+   Chunk chunk;
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include "Expr.h"
+#include "Statement.h"
+#include "Executor.h"
+#include "Arena.h"
+
+/*
+   Compiles a resolved program into a tree of executors, closures that run on the Interpreter's environments
+   Every decision the tree-walker makes on each visit (which node this is, which operator, local or global) is made once here,
+   running the program is then only calls from executor to executor.
+   Function bodies are compiled into a FunctionBody in the program's arena, LoxFunction runs that when it is there
+*/
+class ClosureCompiler : ExprVisitor, StmtVisitor {
+public:
+   Value visit_BinaryExpr  (Binary* expr)   override;
+   Value visit_GroupExpr   (Group* expr)    override;
+   Value visit_LiteralExpr (Literal* expr)  override;
+   Value visit_UnaryExpr   (Unary* expr)    override;
+   Value visit_VariableExpr(Variable* expr) override;
+   Value visit_AssignExpr  (Assign* expr)   override;
+   Value visit_LogicalExpr (Logical* expr)  override;
+   Value visit_CallExpr    (Call* expr)     override;
+   Value visit_GetExpr     (Get* expr)      override;
+   Value visit_SetExpr     (Set* expr)      override;
+   Value visit_ThisExpr    (This* expr)     override;
+   Value visit_SuperExpr   (Super* expr)    override;
+   Completion visit_ExpressionStmt (Expression* stmt) override;
+   Completion visit_PrintStmt      (Print* stmt)      override;
+   Completion visit_VarStmt        (Var* stmt)        override;
+   Completion visit_BlockStmt      (Block* stmt)      override;
+   Completion visit_IfStmt         (If* stmt)         override;
+   Completion visit_WhileStmt      (While* stmt)      override;
+   Completion visit_FunctionStmt   (Function* stmt)   override;
+   Completion visit_ReturnStmt     (Return* stmt)     override;
+   Completion visit_ClassStmt      (Class* stmt)      override;
+
+   explicit ClosureCompiler(Arena& arena);
+   std::vector<StmtExecutor> compile(const std::vector<Stmt*>& statements);
+private:
+   Arena& arena;
+   // * The visitors leave the executor they built here, compile() picks it up
+   ExprExecutor expr_result;
+   StmtExecutor stmt_result;
+private:
+   ExprExecutor compile(Expr* expr);
+   StmtExecutor compile(Stmt* stmt);
+   void compile_body(Function* function);
+   template <typename Operation>
+   ExprExecutor numeric(Binary* expr, ExprExecutor left, ExprExecutor right, Operation operation);
+   ExprExecutor variable(const Token& name, Resolution& resolution);
+};
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Expr.h"
+#include "Statement.h"
+#include "Resolver.h"
+#include "Chunk.h"
+#include "Program.h"
+#include "ErrorReporter.h"
+
+class VM;
+
+/*
+   Compiles a resolved Program to bytecode for the VM
+   The compiler opens a scope wherever the Resolver opened one and adds the variables to it in the same order,
+   so the depth and slot the Resolver stored on a node find the variable here as well.
+   All that is left to decide is where the variable lives: a slot on the VM's stack, or an upvalue when it belongs to an enclosing function.
+   Programs that go past one of the VM's limits (see Chunk.h) get a compile error, reported once per function and limit
+*/
+class Compiler : ExprVisitor, StmtVisitor {
+public:
+   Value visit_BinaryExpr  (Binary* expr)   override;
+   Value visit_GroupExpr   (Group* expr)    override;
+   Value visit_LiteralExpr (Literal* expr)  override;
+   Value visit_UnaryExpr   (Unary* expr)    override;
+   Value visit_VariableExpr(Variable* expr) override;
+   Value visit_AssignExpr  (Assign* expr)   override;
+   Value visit_LogicalExpr (Logical* expr)  override;
+   Value visit_CallExpr    (Call* expr)     override;
+   Value visit_GetExpr     (Get* expr)      override;
+   Value visit_SetExpr     (Set* expr)      override;
+   Value visit_ThisExpr    (This* expr)     override;
+   Value visit_SuperExpr   (Super* expr)    override;
+   Completion visit_ExpressionStmt (Expression* stmt) override;
+   Completion visit_PrintStmt      (Print* stmt)      override;
+   Completion visit_VarStmt        (Var* stmt)        override;
+   Completion visit_BlockStmt      (Block* stmt)      override;
+   Completion visit_IfStmt         (If* stmt)         override;
+   Completion visit_WhileStmt      (While* stmt)      override;
+   Completion visit_FunctionStmt   (Function* stmt)   override;
+   Completion visit_ReturnStmt     (Return* stmt)     override;
+   Completion visit_ClassStmt      (Class* stmt)      override;
+
+   Compiler(VM& vm, Program& program, ErrorReporter& errors);
+   VMFunction* compile(); // * The top level code as a function without parameters
+private:
+   // * A variable in one of the scopes, function is the index of the function whose stack slot it occupies
+   struct Local {
+      int function;
+      int slot;
+      bool captured = false;
+   };
+
+   enum Limit : unsigned { LOCALS = 1, UPVALUES = 2, CONSTANTS = 4, CACHES = 8, FUNCTIONS = 16, GLOBALS = 32, JUMP = 64, LOOP = 128 };
+
+   struct FunctionState {
+      VMFunction* function;
+      FunctionType type;
+      int local_count;
+      unsigned limits_reported = 0;
+   };
+
+   VM& vm;
+   Program& program;
+   ErrorReporter& errors;
+   std::vector<FunctionState> functions;
+   std::vector<std::vector<Local>> scopes;
+private:
+   void compile(Stmt* stmt);
+   void compile(Expr* expr);
+   void compile(const std::vector<Stmt*>& statements);
+   int compile_function(Function* declaration, FunctionType type);
+   Chunk& chunk();
+
+   void emit(OpCode op, const Token* token = nullptr);
+   void emit_byte(int byte, const Token* token);
+   void emit_short(int value, const Token* token);
+   void emit_index(int index, const Token* token);
+   void emit_return(const Token* token);
+   int emit_jump(OpCode op, const Token& token);
+   void patch_jump(int offset, const Token& token);
+   void emit_loop(int loop_start, const Token& token);
+   int make_constant(Value value, const Token& token);
+   int make_cache(const Token& token);
+   int make_function(int function, const Token& token);
+   int global_slot(const Token& name);
+   void limit_error(FunctionState& state, Limit limit, const Token& token, const std::string& message);
+
+   void begin_scope();
+   void end_scope();
+   int add_local(const Token& name);
+   void define_variable(const Token& name);
+   void load_variable(const Token& name, const Resolution& resolution);
+   void store_variable(const Token& name, const Resolution& resolution);
+   Local& find_local(const Resolution& resolution);
+   int resolve_upvalue(int function, Local& local, const Token& name);
+   int add_upvalue(int function, bool is_local, int index, const Token& name);
+};
\ No newline at end of file
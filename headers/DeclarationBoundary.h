@@ -0,0 +1,26 @@
+#pragma once
+#include "Token.h"
+
+/*
+   Finds where top level declarations start in a stream of tokens, without parsing them:
+   a declaration ends with a ';' or '}' outside of any braces and parentheses, unless an 'else' follows.
+   That holds for every statement of the grammar, a program with errors is cut in the same places and each part fails on its own
+   Used by Scanner::scan_declaration (--stream) and the ParallelParser (--parallel-parse)
+*/
+class DeclarationBoundary {
+public:
+   // * Every token has to be passed in order, true when this one starts a new declaration
+   bool starts_declaration(const Token& token)
+   {
+      bool starts = at_end_of_statement and token.type != ELSE;
+      if (token.type == LEFT_BRACE or token.type == LEFT_PAREN) {
+         depth++; }
+      else if ((token.type == RIGHT_BRACE or token.type == RIGHT_PAREN) and depth > 0) {
+         depth--; }
+      at_end_of_statement = depth == 0 and (token.type == SEMICOLON or token.type == RIGHT_BRACE);
+      return starts;
+   }
+private:
+   int depth = 0;
+   bool at_end_of_statement = false;
+};
\ No newline at end of file
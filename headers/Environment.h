@@ -1,22 +1,33 @@
 #pragma once
 #include <unordered_map>
-#include <string>
-#include <any>
 #include <memory>
+#include <string>
+#include <vector>
 #include "Token.h"
+#include "Value.h"
 
-class Environment: public std::enable_shared_from_this<Environment> {
+/*
+   Local variables live in a flat array of slots, the Resolver decides which slot each one gets
+   Only the global environment also keeps a name -> slot table, for variables the Resolver could not resolve.
+   Global slots are never removed or reused, so callers may cache the slot a name maps to
+   Closures keep their environment alive and environments hold closures, so environments are traced by the Heap
+*/
+class Environment : public HeapObject {
 public:
-   std::shared_ptr<Environment> enclosing;
-   void define(std::string name, std::any value);
-   std::any get(Token name);
-   std::any get_at( int distance, std::string name);
-   void assign(Token name, std::any value);   
-   void assign_at(int distance, Token name, std::any value);   
-   std::shared_ptr<Environment> ancestor(int distance);
+   Ref<Environment> enclosing;
+   int define(Value value);
+   int define(const std::string& name, Value value);
+   int slot_of(const Token& name);
+   Value get_at(int distance, int slot);
+   void assign_at(int distance, int slot, Value value);   
+   Environment* ancestor(int distance);
+   void reset(Ref<Environment> enclosing);
    Environment();
-   Environment(std::shared_ptr<Environment> enclosing);
+   explicit Environment(Ref<Environment> enclosing);
+   ~Environment();
+   void trace(Tracer& tracer) override;
+   void clear_references() override;
 private:
-   std::unordered_map<std::string, std::any> values;
-};
-
+   std::vector<Value> values;
+   std::unique_ptr<std::unordered_map<std::string, int>> names; // * Made by the first define by name, so only the global environment has one
+};
\ No newline at end of file
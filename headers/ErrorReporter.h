@@ -0,0 +1,27 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include "Token.h"
+#include "RuntimeError.h"
+
+/*
+   Where compile and runtime errors go, one per Isolate
+   The Scanner, Parser, Resolver and Compiler report the errors they find to the reporter they were given,
+   the Interpreter and the VM report the RuntimeError that stopped the program. Nothing in it is shared,
+   so isolates on different threads never write to the same flags or stream
+*/
+class ErrorReporter {
+public:
+   explicit ErrorReporter(std::ostream& err) : err(err) {}
+   void error(int line, const std::string& message);
+   void error(const Token& token, const std::string& message);
+   void runtime_error(const RuntimeError& error);
+   void note(const std::string& message); // * A line that is not an error (--jit-log), it sets no flag
+
+   bool had_error = false;
+   bool had_runtime_error = false;
+private:
+   std::ostream& err;
+private:
+   void report(int line, const std::string& where, const std::string& message);
+};
\ No newline at end of file
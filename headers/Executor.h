@@ -0,0 +1,15 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "Value.h"
+#include "Statement.h"
+
+class Interpreter;
+
+// * What the ClosureCompiler turns nodes into: callables with everything about the node fixed when they were made
+using ExprExecutor = std::function<Value(Interpreter&)>;
+using StmtExecutor = std::function<Completion(Interpreter&)>;
+
+struct FunctionBody {
+   std::vector<StmtExecutor> statements;
+};
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <memory>
 #include <vector>
 #include "Token.h"
+#include "Value.h"
+#include "Shape.h"
 
 struct Binary;
 struct Group;
@@ -16,28 +18,39 @@ struct Set;
 struct This;
 struct Super;
 
+// * Where the Resolver found a variable: how many environments up and which slot inside that environment
+// * Variables the Resolver could not find keep a depth of -1 and are looked up in the globals,
+// * the interpreter then caches their global slot here after the first successful lookup
+struct Resolution {
+   int depth = -1;
+   int slot = -1;
+
+   bool is_local() const { return depth >= 0; }
+};
+
 struct ExprVisitor {
-  virtual std::any visit_BinaryExpr  (std::shared_ptr<Binary> expr)   = 0;
-  virtual std::any visit_GroupExpr   (std::shared_ptr<Group> expr)    = 0;
-  virtual std::any visit_LiteralExpr (std::shared_ptr<Literal> expr)  = 0;
-  virtual std::any visit_UnaryExpr   (std::shared_ptr<Unary> expr)    = 0;
-  virtual std::any visit_VariableExpr(std::shared_ptr<Variable> expr) = 0;
-  virtual std::any visit_AssignExpr  (std::shared_ptr<Assign> expr)   = 0;
-  virtual std::any visit_LogicalExpr (std::shared_ptr<Logical> expr)  = 0;
-  virtual std::any visit_CallExpr    (std::shared_ptr<Call> expr)     = 0;
-  virtual std::any visit_GetExpr     (std::shared_ptr<Get> expr)      = 0;
-  virtual std::any visit_SetExpr     (std::shared_ptr<Set> expr)      = 0;
-  virtual std::any visit_ThisExpr    (std::shared_ptr<This> expr)     = 0;
-  virtual std::any visit_SuperExpr   (std::shared_ptr<Super> expr)    = 0;
+  virtual Value visit_BinaryExpr  (Binary* expr)   = 0;
+  virtual Value visit_GroupExpr   (Group* expr)    = 0;
+  virtual Value visit_LiteralExpr (Literal* expr)  = 0;
+  virtual Value visit_UnaryExpr   (Unary* expr)    = 0;
+  virtual Value visit_VariableExpr(Variable* expr) = 0;
+  virtual Value visit_AssignExpr  (Assign* expr)   = 0;
+  virtual Value visit_LogicalExpr (Logical* expr)  = 0;
+  virtual Value visit_CallExpr    (Call* expr)     = 0;
+  virtual Value visit_GetExpr     (Get* expr)      = 0;
+  virtual Value visit_SetExpr     (Set* expr)      = 0;
+  virtual Value visit_ThisExpr    (This* expr)     = 0;
+  virtual Value visit_SuperExpr   (Super* expr)    = 0;
   virtual ~ExprVisitor() = default;
 };
 
 struct Expr {
-   virtual std::any accept(ExprVisitor& visitor) = 0;
+   virtual Value accept(ExprVisitor& visitor) = 0;
 };
 
 /*
-   Inherting std::enable_shared_from_this allows the object to return a shared pointer pointing to itself
+   Nodes are allocated in the Program's Arena and point to their children with plain pointers,
+   tokens are referenced in the Program's token list rather than copied
 
    These are all tree nodes with slightly different attributes
    For example:
@@ -47,117 +60,127 @@ struct Expr {
             true  false 
 */ 
 
-struct Binary : Expr, std::enable_shared_from_this<Binary>
+struct Binary : Expr
 {
-   const std::shared_ptr<Expr> left;
-   const Token op;
-   const std::shared_ptr<Expr> right;
+   Expr* const left;
+   const Token& op;
+   Expr* const right;
 
-   Binary(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right);
+   Binary(Expr* left, const Token& op, Expr* right);
 
-   std::any accept(ExprVisitor &visitor) override;
+   Value accept(ExprVisitor &visitor) override;
 };
 
 
 
 
-struct Group : Expr, public std::enable_shared_from_this<Group>
+struct Group : Expr
 {
-    const std::shared_ptr<Expr> expr_in;
+    Expr* const expr_in;
 
-    explicit Group(std::shared_ptr<Expr> expr);
+    explicit Group(Expr* expr);
 
-    std::any accept(ExprVisitor &visitor) override;
+    Value accept(ExprVisitor &visitor) override;
 };
 
-struct Literal : Expr, public std::enable_shared_from_this<Literal>
+struct Literal : Expr
 {
-    const std::any value;
+    const Token& token; // * The literal itself, or the operator whose operands the Optimizer folded into it
+    const Value value;
 
-    explicit Literal(std::any value);
+    Literal(const Token& token, Value value);
 
-    std::any accept(ExprVisitor &visitor) override;
+    Value accept(ExprVisitor &visitor) override;
 };
 
-struct Unary : Expr, public std::enable_shared_from_this<Unary>
+struct Unary : Expr
 {
-    const Token op;
-    const std::shared_ptr<Expr> right;
+    const Token& op;
+    Expr* const right;
 
-    Unary(Token op, std::shared_ptr<Expr> right);
+    Unary(const Token& op, Expr* right);
 
-    std::any accept(ExprVisitor &visitor) override;
+    Value accept(ExprVisitor &visitor) override;
 };
 
-struct Variable: Expr, public std::enable_shared_from_this<Variable> {
-  Variable(Token name);
+struct Variable: Expr {
+  Variable(const Token& name);
 
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
 
-  const Token name;
+  const Token& name;
+  Resolution resolution; // * Written by the Resolver
 };
 
-struct Assign: Expr, public std::enable_shared_from_this<Assign> {
-  Assign(Token name, std::shared_ptr<Expr> value);
+struct Assign: Expr {
+  Assign(const Token& name, Expr* value);
 
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
 
-  const Token name;
-  const std::shared_ptr<Expr> value;
+  const Token& name;
+  Expr* const value;
+  Resolution resolution;
 };
 
-struct Logical: Expr, public std::enable_shared_from_this<Logical> {
-  Logical(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right);
+struct Logical: Expr {
+  Logical(Expr* left, const Token& op, Expr* right);
   
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
   
-  const std::shared_ptr<Expr> left;
-  const Token op;
-  const std::shared_ptr<Expr> right;
+  Expr* const left;
+  const Token& op;
+  Expr* const right;
 };
 
-struct Call: Expr, public std::enable_shared_from_this<Call> {
-  Call(std::shared_ptr<Expr> calle, Token paren, std::vector<std::shared_ptr<Expr>> arguements);
+struct Call: Expr {
+  Call(Expr* calle, const Token& paren, std::vector<Expr*> arguements);
 
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
 
-  const std::shared_ptr<Expr> calle;
-  const Token paren;
-  const std::vector<std::shared_ptr<Expr>> arguements;
+  Expr* const calle;
+  const Token& paren;
+  const std::vector<Expr*> arguements;
+  Get* const property; // * Set when the callee is a Get, like obj.method(), so the method can be invoked without binding it
+  Super* const super_property; // * Likewise for super.method()
 };
 
-struct Get: Expr, public std::enable_shared_from_this<Get> {
-  Get(std::shared_ptr<Expr> object, Token name);
+struct Get: Expr {
+  Get(Expr* object, const Token& name);
 
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
 
-  const std::shared_ptr<Expr> object;
-  const Token name;
+  Expr* const object;
+  const Token& name;
+  PropertyCache cache;
 };
 
-struct Set: Expr, public std::enable_shared_from_this<Set> {
-  Set(std::shared_ptr<Expr> object, Token name, std::shared_ptr<Expr> value);
+struct Set: Expr {
+  Set(Expr* object, const Token& name, Expr* value);
 
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
   
-  std::shared_ptr<Expr> object;
-  Token name;
-  std::shared_ptr<Expr> value;
+  Expr* object;
+  const Token& name;
+  Expr* value;
+  PropertyCache cache;
 };
 
-struct This: Expr, public std::enable_shared_from_this<This> {
-  This(Token keyword);
+struct This: Expr {
+  This(const Token& keyword);
   
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
   
-  const Token keyword;
+  const Token& keyword;
+  Resolution resolution;
 };
 
-struct Super: Expr, public std::enable_shared_from_this<Super>{
-  Super(Token keyword, Token method);
+struct Super: Expr{
+  Super(const Token& keyword, const Token& method);
   
-  std::any accept(ExprVisitor& visitor) override;
+  Value accept(ExprVisitor& visitor) override;
   
-  const Token keyword;
-  const Token method;
+  const Token& keyword;
+  const Token& method;
+  Resolution resolution;
+  PropertyCache cache; // * The method found in the superclasses seen here
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include "Pool.h"
+
+class Value;
+class HeapObject;
+
+// * Handed to HeapObject::trace, which passes it every reference the object counts
+class Tracer {
+public:
+   virtual void visit(HeapObject* object) = 0; // * nullptr is fine
+   void visit(const Value& value);
+protected:
+   ~Tracer() = default;
+};
+
+/*
+   Base of everything the runtime reference counts: Lox values and the environments and upvalues they live in
+   The last reference going away frees an object right away, the Heap only has to deal with cycles (see below).
+   Classes whose objects can hold references, and so be part of a cycle, call track() in their constructors and override
+   trace, which must visit exactly the references the object counts, and clear_references, which drops them all.
+   They are allocated from the Pool
+*/
+class HeapObject {
+public:
+   HeapObject() = default;
+   HeapObject(const HeapObject&) = delete;
+   HeapObject& operator=(const HeapObject&) = delete;
+   virtual ~HeapObject();
+
+   static void* operator new(std::size_t size) { return Pool::allocate(size); }
+   static void operator delete(void* object, std::size_t size) { Pool::free(object, size); } // * The size of the object's own class
+
+   void retain() { ++ref_count; }
+   void release() { if (--ref_count == 0) { delete this; } }
+   int reference_count() const { return ref_count; }
+
+   virtual void trace(Tracer&) {}
+   virtual void clear_references() {}
+protected:
+   void track();
+private:
+   friend class Heap;
+   int ref_count = 0;
+   int gc_refs = 0;          // * Scratch for the collector
+   bool tracked = false;
+   bool reachable = false;
+   HeapObject* previous = nullptr; // * The Heap's list of tracked objects
+   HeapObject* next = nullptr;
+};
+
+/*
+   Collects the reference cycles that counting alone never frees, like a closure stored in the environment it closes over
+   or an instance holding itself. Mark-sweep over the tracked objects:
+    - the roots are the objects referenced from outside the tracked heap: from the interpreter's environment stack,
+      the VM's stack and globals, the AST's constants and caches and whatever the C++ code running at the moment holds.
+      They are found without walking any of those, by taking the references the tracked objects hold on each other
+      off every reference count: what is left over comes from outside
+    - everything reachable from a root is marked, the rest is garbage: it is kept alive while all of its references
+      are cleared, which breaks the cycles, then let go so the counts free it
+   Collections only run at safe points (Interpreter::collect_if_due, the VM's calls and loops), never inside an allocation,
+   once as many objects were tracked since the last collection as survived it.
+   Every Isolate has its own heap. Objects are tracked by the heap a Scope made current on the thread creating them,
+   objects created outside of any are only reference counted. The list of tracked objects is circular around a sentinel,
+   so an object can leave it without knowing which heap it is in
+*/
+class Heap {
+public:
+   Heap();
+   ~Heap(); // * Objects still tracked are only reference counted from then on
+   Heap(const Heap&) = delete;
+   Heap& operator=(const Heap&) = delete;
+
+   bool collection_due() const { return tracked_since_collection >= next_collection; }
+   void collect();
+   void print_stats(std::ostream& out) const; // * --gc-stats
+
+   // * Makes a heap the one objects created on this thread are tracked by, until the scope ends
+   class Scope {
+   public:
+      explicit Scope(Heap& heap) : previous(current) { current = &heap; }
+      ~Scope() { current = previous; }
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+   private:
+      Heap* const previous;
+   };
+
+private:
+   friend class HeapObject;
+   static constexpr std::size_t MIN_COLLECTION = 16 * 1024;
+   static thread_local inline Heap* current = nullptr;
+
+   HeapObject objects; // * The sentinel of the list
+   std::size_t tracked_since_collection = 0;
+   std::size_t next_collection = MIN_COLLECTION;
+
+   std::size_t collections = 0;
+   std::size_t objects_freed = 0;
+   std::size_t survivors = 0;      // * Of the last collection
+   std::size_t most_survivors = 0;
+   double total_pause_ms = 0;
+   double longest_pause_ms = 0;
+private:
+   void track(HeapObject* object);
+};
\ No newline at end of file
@@ -3,65 +3,76 @@
 #include "Statement.h"
 #include "Environment.h"
 #include "LoxCallable.h"
-#include <chrono>
-#include "map"
+#include "Executor.h"
+#include "Jit.h"
+#include "ErrorReporter.h"
+#include "Heap.h"
+#include <ostream>
+
+class LoxFunction;
 
 class Interpreter : public ExprVisitor, public StmtVisitor {
+   friend class ClosureCompiler; // * Its executors run on the Interpreter's environments
 public:
-   std::any visit_BinaryExpr  (std::shared_ptr<Binary> expr)   override;
-   std::any visit_GroupExpr   (std::shared_ptr<Group> expr)    override;
-   std::any visit_LiteralExpr (std::shared_ptr<Literal> expr)  override;
-   std::any visit_UnaryExpr   (std::shared_ptr<Unary> expr)    override;
-   std::any visit_VariableExpr(std::shared_ptr<Variable> expr) override;
-   std::any visit_AssignExpr  (std::shared_ptr<Assign> expr)   override; 
-   std::any visit_LogicalExpr (std::shared_ptr<Logical> expr)  override; 
-   std::any visit_CallExpr    (std::shared_ptr<Call> expr)     override; 
-   std::any visit_GetExpr     (std::shared_ptr<Get> expr)      override; 
-   std::any visit_SetExpr     (std::shared_ptr<Set> expr)      override; 
-   std::any visit_ThisExpr    (std::shared_ptr<This> expr)     override; 
-   std::any visit_SuperExpr   (std::shared_ptr<Super> expr)    override; 
-   std::any visit_ExpressionStmt (std::shared_ptr<Expression> stmt) override;
-   std::any visit_PrintStmt      (std::shared_ptr<Print> stmt)      override;
-   std::any visit_VarStmt        (std::shared_ptr<Var> stmt)        override;
-   std::any visit_BlockStmt      (std::shared_ptr<Block> stmt)      override;
-   std::any visit_IfStmt         (std::shared_ptr<If> stmt)         override;
-   std::any visit_WhileStmt      (std::shared_ptr<While> stmt)      override;
-   std::any visit_FunctionStmt   (std::shared_ptr<Function> stmt)   override;
-   std::any visit_ReturnStmt     (std::shared_ptr<Return> stmt)     override;
-   std::any visit_ClassStmt      (std::shared_ptr<Class> stmt)      override;
-   Interpreter();
+   Value visit_BinaryExpr  (Binary* expr)   override;
+   Value visit_GroupExpr   (Group* expr)    override;
+   Value visit_LiteralExpr (Literal* expr)  override;
+   Value visit_UnaryExpr   (Unary* expr)    override;
+   Value visit_VariableExpr(Variable* expr) override;
+   Value visit_AssignExpr  (Assign* expr)   override; 
+   Value visit_LogicalExpr (Logical* expr)  override; 
+   Value visit_CallExpr    (Call* expr)     override; 
+   Value visit_GetExpr     (Get* expr)      override; 
+   Value visit_SetExpr     (Set* expr)      override; 
+   Value visit_ThisExpr    (This* expr)     override; 
+   Value visit_SuperExpr   (Super* expr)    override; 
+   Completion visit_ExpressionStmt (Expression* stmt) override;
+   Completion visit_PrintStmt      (Print* stmt)      override;
+   Completion visit_VarStmt        (Var* stmt)        override;
+   Completion visit_BlockStmt      (Block* stmt)      override;
+   Completion visit_IfStmt         (If* stmt)         override;
+   Completion visit_WhileStmt      (While* stmt)      override;
+   Completion visit_FunctionStmt   (Function* stmt)   override;
+   Completion visit_ReturnStmt     (Return* stmt)     override;
+   Completion visit_ClassStmt      (Class* stmt)      override;
+   Interpreter(std::ostream& out, ErrorReporter& errors, Heap& heap); // * Where print writes, runtime errors go and objects are collected
    ~Interpreter() = default ;
 
-   void interpret(std::vector<std::shared_ptr<Stmt>> staments);
-   void execute_block(std::vector<std::shared_ptr<Stmt>> statements, std::shared_ptr<Environment> environment);
-   void resolve(std::shared_ptr<Expr> expr, int depth);
+   void interpret(std::vector<Stmt*> staments);
+   void interpret(const std::vector<StmtExecutor>& statements);
+   Completion execute_block(const std::vector<Stmt*>& statements, Ref<Environment> environment);
+   Completion execute_block(const std::vector<StmtExecutor>& statements, Ref<Environment> environment);
+   Ref<Environment> acquire_environment(Ref<Environment> enclosing);
+   void release_environment(Ref<Environment> environment);
 
-//* Environments can hold a reference to their enclosing (parent) environement and that is why we use a shared pointer 
-public: std::shared_ptr<Environment> global_environment{std::make_shared<Environment>()};
+//* Environments can hold a reference to their enclosing (parent) environement and that is why they are reference counted
+public: Ref<Environment> global_environment{new Environment()};
+public:
+   Jit jit;
+   Function* current_function = nullptr; //* The function whose body is running, loop iterations count towards its hotness
+   void count_back_edge();
+   void collect_if_due() { if (heap.collection_due()) { heap.collect(); } } //* Between statements and loop iterations nothing is held by a raw pointer alone
 private: 
-   std::shared_ptr<Environment> environment = global_environment;
-   std::map<std::shared_ptr<Expr>, int> locals;
+   std::ostream& out;
+   ErrorReporter& errors;
+   Heap& heap;
+   Ref<Environment> environment = global_environment;
+   std::vector<Ref<Environment>> environment_pool; //* Finished environments nothing captured, reused by blocks and calls
    
 private:
-   std::any evaluate(std::shared_ptr<Expr> expr);
-   void execute(std::shared_ptr<Stmt> stmt);
-   bool is_truthy(std::any object);
-   bool is_equal(std::any a, std::any b);
-   void assert_number_operand(Token op, std::any object);
-   void assert_number_operands(Token op, std::any left, std::any right);
-   std::string stringify(std::any object);
-   std::any look_up_variable(Token name, std::shared_ptr<Expr> expr);
-};
-
-class NativeClock: public LoxCallable {
-public:
-   int arity() override { return 0; }
-
-   std::any call(Interpreter& interpreter, const std::vector<std::any> arguments) override 
-   {
-      auto ticks = std::chrono::system_clock::now().time_since_epoch();
-      return std::chrono::duration<double>{ticks}.count() / 1000.0;
-   }
-
-   std::string to_string() override { return "<native fn>"; }
+   Value evaluate(Expr* expr);
+   Completion execute(Stmt* stmt);
+   Completion execute(const StmtExecutor& stmt);
+   template <typename Statement>
+   Completion run_block(const std::vector<Statement>& statements, Ref<Environment> environment);
+   int define_variable(const Token& name, Value value);
+   void assert_number_operand(const Token& op, const Value& object);
+   void assert_number_operands(const Token& op, const Value& left, const Value& right);
+   Value call_function(LoxFunction* function, Ref<Environment> frame, Call* expr);
+   Value call_frame(LoxFunction* function, Ref<Environment> frame, int argument_count, const Token& paren);
+   Value call_callable(const Value& callee, std::vector<Value> arguments, const Token& paren);
+   Value get_property(const Value& object, const Token& name, PropertyCache& cache);
+   LoxFunction* find_super_method(Super* expr, const Value& superclass); // * Throws when the superclass has no such method
+   Value look_up_variable(const Token& name, Resolution& resolution);
+   int global_slot(const Token& name, Resolution& resolution);
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ErrorReporter.h"
+#include "Heap.h"
+#include "Interpreter.h"
+#include "VM.h"
+#include "Program.h"
+#include "ProgramImage.h"
+#include "SourceText.h"
+
+/*
+   One embeddable interpreter: the programs it ran, the Interpreter and the VM with their globals, the Heap their objects
+   are tracked in and where printed output and errors go. Isolates share nothing that changes, so several can run at once
+   on different threads, as long as each one is used by a single thread at a time.
+   The only things they can share are ProgramImages: a program compiled once (see compile) can be run by every isolate
+*/
+class Isolate {
+public:
+   // * Which backend runs the program: walking the tree, closures compiled from it (--closures) or bytecode on the VM (--vm)
+   // * EMIT_C (--emit-c) does not run it, it prints the program translated to C++
+   enum class Backend { INTERPRETER, CLOSURES, VM, EMIT_C };
+   struct Options {
+      Backend backend = Backend::INTERPRETER;
+      bool use_cache = true;       // * Off with --no-cache
+      bool parallel_parse = false; // * --parallel-parse, see ParallelParser
+      bool jit = true;             // * Off with --no-jit
+      bool jit_log = false;        // * --jit-log
+   };
+
+   Isolate(const Options& options, std::ostream& out, std::ostream& err);
+   ~Isolate();
+   Isolate(const Isolate&) = delete;
+   Isolate& operator=(const Isolate&) = delete;
+
+   void run(std::unique_ptr<SourceText> source, const std::string& path = "");
+   void run_stream(std::unique_ptr<SourceText> source);
+   // * Compiles the source for other isolates to run, nullptr when it has errors, they are reported like run reports them
+   std::shared_ptr<const ProgramImage> compile(std::unique_ptr<SourceText> source, const std::string& path = "");
+   void run(const ProgramImage& image);
+
+   bool had_error() const { return errors.had_error; }
+   bool had_runtime_error() const { return errors.had_runtime_error; }
+   void forget_errors() { errors.had_error = errors.had_runtime_error = false; } // * The REPL goes on after an error
+   void print_gc_stats(std::ostream& stats) const { heap.print_stats(stats); }
+
+private:
+   const Options options;
+   std::ostream& out;
+   ErrorReporter errors;
+   Heap heap;
+   std::vector<std::unique_ptr<Program>> programs; // * Destroyed after the interpreter and the VM, see ~Isolate
+   std::unique_ptr<Interpreter> interpreter;
+   std::unique_ptr<VM> vm;
+private:
+   void execute(Program& program);
+   bool build(std::string_view source, std::unique_ptr<Program>& program, const std::string& path);
+   bool compile_source(std::string_view source, Program& program);
+   bool parse(Program& program);
+};
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Statement.h"
+#include "Environment.h"
+#include "ErrorReporter.h"
+
+/*
+   Baseline JIT for the tree-walker: functions that only compute with numbers, their own locals and calls to other such functions
+   are compiled to x86-64 once they got hot (calls plus loop iterations, counted while they are interpreted).
+   Compiled code keeps every value as a double in its native frame, it never sees a Value.
+
+   The assumptions are guarded: arguments must be numbers when the interpreter calls in, the global a call site reads
+   must still hold the function it held at compile time, and the function must return a number.
+   Since nothing compiled has side effects, a failed guard simply abandons the native run and the interpreter runs the call
+   from the start. The function whose guard failed, which can be a callee of the one the interpreter called, is deoptimized
+   for good and the interpreter keeps running it from then on. Its code stays installed for the compiled functions that call it,
+   it still checks its own guards. Calls nested too deep count as a failed guard of the function making the deepest call
+*/
+
+class JitFunction;
+
+// * What generated code has in rbx: the globals call sites look their callee up in, and the flag that makes it return early
+struct JitContext {
+   Environment* globals;
+   int depth = 0;
+   bool bailout = false;
+   const char* reason = nullptr;
+   JitFunction* culprit = nullptr; // * The function whose guard failed
+};
+
+using JitEntry = double (*)(JitContext* context, const double* arguments);
+
+struct JitCallSite {
+   int global_slot;
+   Function* declaration; // * What the global held at compile time
+   JitFunction* target;
+   JitFunction* caller; // * The function the call is in, a failed guard here is its own
+};
+
+class JitFunction {
+public:
+   explicit JitFunction(Function* declaration);
+   ~JitFunction();
+   JitFunction(const JitFunction&) = delete;
+   JitFunction& operator=(const JitFunction&) = delete;
+
+   Function* const declaration;
+   JitEntry entry = nullptr; // * nullptr until the code is installed
+   std::vector<std::unique_ptr<JitCallSite>> call_sites;
+
+   bool install(const std::vector<std::uint8_t>& code);
+   std::size_t size() const { return code_size; }
+private:
+   void* memory = nullptr;
+   std::size_t mapped_size = 0;
+   std::size_t code_size = 0;
+};
+
+class Jit {
+public:
+   static constexpr int HOT_THRESHOLD = 1000;
+   static constexpr int MAX_DEPTH = 10000; // * Native calls deeper than this bail out, the interpreter reports what happens then
+   static constexpr int MAX_ARGUMENTS = 255;
+
+   Jit(Environment& globals, ErrorReporter& errors);
+   bool enabled = true;
+   bool log = false;  // * One line per function compiled, rejected or deoptimized, written where errors go
+
+   bool run(Function* declaration, Environment& frame, Value& result); // * false when the interpreter has to run the call
+   JitFunction* compile(Function* declaration);                          // * nullptr when the function can not be compiled
+
+   // * Called from generated code
+   static double call(JitContext* context, JitCallSite* site, const double* arguments);
+   static double fall_off_end(JitContext* context, JitFunction* function, const double* arguments);
+private:
+   Environment& globals;
+   ErrorReporter& errors;
+   std::vector<std::unique_ptr<JitFunction>> functions;
+private:
+   void deoptimize(Function* declaration, const std::string& reason);
+   void report(const Function* declaration, const std::string& message);
+};
\ No newline at end of file
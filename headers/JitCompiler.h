@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Expr.h"
+#include "Statement.h"
+#include "Assembler.h"
+#include "Jit.h"
+
+/*
+   Generates the x86-64 code of one function for the Jit
+   Every local gets its own slot in the native frame, found through the same scopes the Resolver built.
+   Expressions leave their value in xmm0, conditions are compiled straight to jumps.
+   Anything the JIT can not handle throws Unsupported, whose reason ends up in the JIT log
+*/
+class JitCompiler : ExprVisitor, StmtVisitor {
+public:
+   Value visit_BinaryExpr  (Binary* expr)   override;
+   Value visit_GroupExpr   (Group* expr)    override;
+   Value visit_LiteralExpr (Literal* expr)  override;
+   Value visit_UnaryExpr   (Unary* expr)    override;
+   Value visit_VariableExpr(Variable* expr) override;
+   Value visit_AssignExpr  (Assign* expr)   override;
+   Value visit_LogicalExpr (Logical* expr)  override;
+   Value visit_CallExpr    (Call* expr)     override;
+   Value visit_GetExpr     (Get* expr)      override;
+   Value visit_SetExpr     (Set* expr)      override;
+   Value visit_ThisExpr    (This* expr)     override;
+   Value visit_SuperExpr   (Super* expr)    override;
+   Completion visit_ExpressionStmt (Expression* stmt) override;
+   Completion visit_PrintStmt      (Print* stmt)      override;
+   Completion visit_VarStmt        (Var* stmt)        override;
+   Completion visit_BlockStmt      (Block* stmt)      override;
+   Completion visit_IfStmt         (If* stmt)         override;
+   Completion visit_WhileStmt      (While* stmt)      override;
+   Completion visit_FunctionStmt   (Function* stmt)   override;
+   Completion visit_ReturnStmt     (Return* stmt)     override;
+   Completion visit_ClassStmt      (Class* stmt)      override;
+
+   struct Unsupported {
+      std::string reason;
+   };
+
+   JitCompiler(Jit& jit, Environment& globals, JitFunction& function);
+   std::vector<std::uint8_t> compile();
+private:
+   Jit& jit;
+   Environment& globals;
+   JitFunction& function;
+   Assembler assembler;
+   Assembler::Label exit;
+   std::vector<std::vector<int>> scopes; // * The frame slot of every variable, by the Resolver's scope and slot
+   int slot_count = 0;
+   int pushed = 0; // * Temporaries on the machine stack, a call needs an even number to keep rsp aligned
+private:
+   void compile(Expr* expr);
+   void compile(Stmt* stmt);
+   void compile(const std::vector<Stmt*>& statements);
+   void branch(Expr* condition, bool when, Assembler::Label& target);
+   void push();
+   void pop_operands();
+   int declare();
+   int slot_of(const Token& name, const Resolution& resolution);
+};
\ No newline at end of file
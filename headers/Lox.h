@@ -1,24 +1,25 @@
 #pragma once
 #include <string>
-#include "Token.h"
-#include "RuntimeError.h"
-#include "Interpreter.h"
+#include <memory>
+#include "Isolate.h"
+#include "SourceText.h"
 
+// * The command line: runs a script or the REPL in an Isolate
 class Lox
 {
 public:
   static void run_script(int argc, char const *argv[]);
-  static void error(int line, std::string message);
-  static void error(Token token, std::string message);
-  static void runtime_error(RuntimeError error);
 private:
-  static bool had_error;
-  static bool had_runtime_error;
-  static Interpreter interpreter;
+  // * What the command line asks for besides the Isolate's options
+  struct Settings {
+    bool stream = false;      // * --stream, see Isolate::run_stream
+    bool gc_stats = false;    // * --gc-stats prints what the Heap's collector did when the script ends
+    bool alloc_stats = false; // * --alloc-stats prints the Pool's counters when the script ends
+    int isolates = 1;         // * --isolates N, see run_isolates
+  };
 private:
-  static void run_file(std::string path); 
-  static void run_prompt();
-  static void run(std::string source);
-  static void report(int line, std::string where,  std::string message);
-};
-
+  static void run_file(const std::string& path, const Isolate::Options& options, const Settings& settings);
+  static void run_isolates(std::unique_ptr<SourceText> source, const std::string& path, const Isolate::Options& options, const Settings& settings);
+  static void run_prompt(const Isolate::Options& options, const Settings& settings);
+  static void print_stats(const Isolate& isolate, const Settings& settings, std::ostream& out);
+};
\ No newline at end of file
@@ -1,16 +1,16 @@
 #pragma once
 
-#include <any>
 #include <string>
 #include <vector>
+#include "Value.h"
 
 class Interpreter;
 
-class LoxCallable
+class LoxCallable : public Object
 {
 public:
    virtual int arity() = 0;
    virtual std::string to_string() = 0;
-   virtual std::any call(Interpreter& interpeter, std::vector<std::any> arguments) = 0;
+   virtual Value call(Interpreter& interpeter, const std::vector<Value>& arguments) = 0;
    virtual ~LoxCallable() = default;
-};
\ No newline at end of file
+};
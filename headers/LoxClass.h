@@ -3,18 +3,27 @@
 #include "LoxCallable.h"
 #include <memory>
 #include "LoxFunction.h"
-#include <map>
+#include "Shape.h"
+#include <unordered_map>
 
-class LoxClass : public LoxCallable, public std::enable_shared_from_this<LoxClass>{
+class LoxClass : public LoxCallable {
 public:
-   LoxClass(std::string name, std::shared_ptr<LoxClass> superclass,std::map<std::string, std::shared_ptr<LoxFunction>> methods) 
-      : name(name), superclass(superclass), methods(methods) {}
+   using MethodTable = std::unordered_map<std::string, Ref<LoxFunction>>;
+
+   static constexpr ValueType value_type = ValueType::CLASS;
+   LoxClass(std::string name, Ref<LoxClass> superclass, MethodTable methods);
    const std::string name;
-   const std::shared_ptr<LoxClass> superclass;
-   std::map<std::string, std::shared_ptr<LoxFunction>> methods; //! This is potentially a huge copy operation
+   Ref<LoxClass> superclass;
+   const Ref<Shape> instance_shape{new Shape()}; // * The Shape new instances start out with
+   Ref<LoxFunction> initializer;                // * "init", possibly inherited, looked up once since every construction needs it
 public:
    std::string to_string() override { return name; }
-   std::any call(Interpreter& interpeter, std::vector<std::any> arguments) override;
+   Value call(Interpreter& interpeter, const std::vector<Value>& arguments) override;
    int arity();
-   std::shared_ptr<LoxFunction> find_method(std::string name);
-};
+   LoxFunction* find_method(const std::string& name);
+   LoxFunction* find_method(std::string_view name, PropertyCache& cache); // * For super.name, cached on instance_shape
+   void trace(Tracer& tracer) override;
+   void clear_references() override;
+private:
+   MethodTable methods; // * Flattened: the class's own methods plus every inherited one they do not override
+};
\ No newline at end of file
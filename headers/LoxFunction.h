@@ -2,21 +2,31 @@
 #include "LoxCallable.h"
 #include "Statement.h"
 #include "Environment.h"
+#include "Resolver.h"
 
 
 class LoxInstance;
 
 class LoxFunction : public LoxCallable 
 {
+   friend class Jit;         // * Compiled call sites check which declaration a global function has
+   friend class JitCompiler;
 public:
+   static constexpr ValueType value_type = ValueType::FUNCTION;
    int arity() override;
    std::string to_string() override;
-   std::any call(Interpreter& interpeter, std::vector<std::any> arguments) override;
-   std::shared_ptr<LoxFunction> bind(std::shared_ptr<LoxInstance> instance);
-   LoxFunction(std::shared_ptr<Function> declaration, std::shared_ptr<Environment> closure, bool is_initializer);
+   Value call(Interpreter& interpeter, const std::vector<Value>& arguments) override;
+   Ref<Environment> new_frame(Interpreter& interpeter);
+   Ref<Environment> new_frame(Interpreter& interpeter, const Value& instance);
+   Value call(Interpreter& interpeter, Ref<Environment> frame);
+   Ref<LoxFunction> bind(Value instance);
+   LoxFunction(Function* declaration, Ref<Environment> closure, FunctionType type, Value receiver = nullptr);
+   void trace(Tracer& tracer) override;
+   void clear_references() override;
 private:
-   std::shared_ptr<Function> declaration;
-   std::shared_ptr<Environment> closure;
-   bool is_initializer;
+   Function* declaration;
+   Ref<Environment> closure;
+   FunctionType type;
+   Value receiver; // * The instance a bound method runs on, nil for plain functions and unbound methods
    
-};
\ No newline at end of file
+};
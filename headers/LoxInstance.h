@@ -2,16 +2,26 @@
 #include "LoxClass.h"
 #include "memory"
 #include "Token.h"
-#include <map>
+#include "Shape.h"
+#include <string_view>
+#include <vector>
 
-class LoxInstance : public std::enable_shared_from_this<LoxInstance> {
+class LoxInstance : public Object {
 public:
-   LoxInstance(std::shared_ptr<LoxClass> lox_class);
-   std::string to_string(); 
-   std::any get(Token name); 
-   void set(Token name, std::any value);
+   static constexpr ValueType value_type = ValueType::INSTANCE;
+   LoxInstance(Ref<LoxClass> lox_class);
+   ~LoxInstance();
+   std::string to_string() override; 
+   Value get(const Token& name, PropertyCache& cache); 
+   void set(const Token& name, Value value, PropertyCache& cache);
+   LoxFunction* find_method(std::string_view name, PropertyCache& cache);
+   void trace(Tracer& tracer) override;
+   void clear_references() override;
 
 private:
-   std::shared_ptr<LoxClass> lox_class;
-   std::map<std::string, std::any> fields;
+   Ref<LoxClass> lox_class;
+   Ref<Shape> shape;
+   std::vector<Value> fields; // * Laid out as described by shape
+private:
+   const PropertyCache::Entry& lookup(std::string_view name, PropertyCache& cache, PropertyCache::Entry& miss);
 };
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#include <chrono>
+#include "LoxCallable.h"
+
+/*
+   Functions implemented in C++, they only look at their arguments so the Interpreter and the VM can both call them
+*/
+class NativeFunction : public LoxCallable {
+public:
+   static constexpr ValueType value_type = ValueType::NATIVE;
+   virtual Value run(const std::vector<Value>& arguments) = 0;
+
+   Value call(Interpreter& interpreter, const std::vector<Value>& arguments) override { return run(arguments); }
+   std::string to_string() override { return "<native fn>"; }
+};
+
+class NativeClock : public NativeFunction {
+public:
+   int arity() override { return 0; }
+
+   Value run(const std::vector<Value>& arguments) override
+   {
+      auto ticks = std::chrono::system_clock::now().time_since_epoch();
+      return std::chrono::duration<double>{ticks}.count() / 1000.0;
+   }
+};
\ No newline at end of file
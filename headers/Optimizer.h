@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "Expr.h"
+#include "Statement.h"
+#include "Arena.h"
+
+/*
+   Rewrites a resolved program before it runs:
+    - arithmetic, comparisons and concatenation on literals are folded into a single literal
+    - branches that can never run are removed, so are while loops whose condition is a falsy literal
+    - groups disappear and double negations that can not change the value are dropped
+   Anything that would throw at runtime (like 1 + "a" or -"a") is left alone so the error still happens, in the same place.
+   Nodes are never changed in place: a node whose children changed is rebuilt in the arena, the rest are shared with the original tree.
+   No scope is added or removed, except together with everything inside it, so the Resolver's depths and slots stay valid
+*/
+class Optimizer : ExprVisitor, StmtVisitor {
+public:
+   Value visit_BinaryExpr  (Binary* expr)   override;
+   Value visit_GroupExpr   (Group* expr)    override;
+   Value visit_LiteralExpr (Literal* expr)  override;
+   Value visit_UnaryExpr   (Unary* expr)    override;
+   Value visit_VariableExpr(Variable* expr) override;
+   Value visit_AssignExpr  (Assign* expr)   override;
+   Value visit_LogicalExpr (Logical* expr)  override;
+   Value visit_CallExpr    (Call* expr)     override;
+   Value visit_GetExpr     (Get* expr)      override;
+   Value visit_SetExpr     (Set* expr)      override;
+   Value visit_ThisExpr    (This* expr)     override;
+   Value visit_SuperExpr   (Super* expr)    override;
+   Completion visit_ExpressionStmt (Expression* stmt) override;
+   Completion visit_PrintStmt      (Print* stmt)      override;
+   Completion visit_VarStmt        (Var* stmt)        override;
+   Completion visit_BlockStmt      (Block* stmt)      override;
+   Completion visit_IfStmt         (If* stmt)         override;
+   Completion visit_WhileStmt      (While* stmt)      override;
+   Completion visit_FunctionStmt   (Function* stmt)   override;
+   Completion visit_ReturnStmt     (Return* stmt)     override;
+   Completion visit_ClassStmt      (Class* stmt)      override;
+
+   explicit Optimizer(Arena& arena);
+   std::vector<Stmt*> optimize(const std::vector<Stmt*>& statements);
+private:
+   Arena& arena;
+   // * The visitors leave the rewritten node here, a statement that was removed leaves nullptr
+   Expr* expr_result = nullptr;
+   Stmt* stmt_result = nullptr;
+private:
+   Expr* optimize(Expr* expr);
+   Stmt* optimize(Stmt* stmt);
+   Stmt* optimize_branch(Stmt* stmt);
+   Expr* optimize_condition(Expr* expr);
+   Function* optimize_function(Function* function);
+   Expr* fold(Binary* expr, const Value& left, const Value& right);
+
+   static const Literal* as_literal(Expr* expr);
+   static bool is_boolean(Expr* expr);
+   static bool is_number(Expr* expr);
+};
\ No newline at end of file
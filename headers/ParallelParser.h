@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include "Token.h"
+#include "Statement.h"
+#include "Arena.h"
+#include "ErrorReporter.h"
+
+/*
+   Parses the top level declarations of a program on several threads (--parallel-parse)
+   The tokens are cut into parts where declarations end (see DeclarationBoundary), every part is parsed by its own Parser
+   into its own arena, then the statements are put back together in source order and the arenas handed to the Program's.
+   Errors have to come out in source order, so the parts report none:
+   when any part has an error the whole program is parsed again by a single Parser, which reports them like without the flag
+*/
+class ParallelParser {
+public:
+   ParallelParser(const std::vector<Token>& tokens, Arena& arena, ErrorReporter& errors);
+   std::vector<Stmt*> parse();
+private:
+   static constexpr int MIN_PART_TOKENS = 4096; // * Less is not worth handing to another thread
+   static constexpr int PARTS_PER_THREAD = 4;   // * A few parts per thread so one long part doesn't keep the others waiting
+
+   struct Part {
+      int begin = 0;
+      int end = 0;
+      Arena arena;
+      std::vector<Stmt*> statements;
+      bool failed = false;
+   };
+
+   const std::vector<Token>& tokens;
+   Arena& arena;
+   ErrorReporter& errors;
+private:
+   std::vector<int> cut(int part_tokens);
+   static void parse_part(const std::vector<Token>& tokens, Part& part);
+};
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include "Token.h"
 #include "Expr.h"
 #include "Statement.h"
+#include "Arena.h"
+#include "ErrorReporter.h"
 
 struct ParseError : public std::runtime_error 
 {
@@ -14,47 +16,54 @@ struct ParseError : public std::runtime_error
 
 class Parser {
 public:
-   Parser(std::vector<Token>& tokens);
-   std::vector<std::shared_ptr<Stmt>> parse();
+   Parser(const std::vector<Token>& tokens, Arena& arena, ErrorReporter& errors);
+   // * Parses only the declarations in [begin, end) and reports no errors, has_error says if there were any (see ParallelParser)
+   Parser(const std::vector<Token>& tokens, Arena& arena, int begin, int end);
+   std::vector<Stmt*> parse();
+   bool has_error() const { return failed; }
 
 private:
    const std::vector<Token>& tokens;
+   Arena& arena; // * Where the AST nodes are allocated, owned by the Program being parsed
    int current = 0;  
+   const int end;
+   ErrorReporter* const errors; // * nullptr for the ParallelParser's parts, they only count their errors: errors have to come out in source order
+   bool failed = false;
 
 private:
-   std::shared_ptr<Expr> expression();
-   std::shared_ptr<Expr> or_expression();
-   std::shared_ptr<Expr> and_expression();
-   std::shared_ptr<Expr> equality();
-   std::shared_ptr<Expr> comparison();
-   std::shared_ptr<Expr> assignment();
-   std::shared_ptr<Expr> term();
-   std::shared_ptr<Expr> factor();
-   std::shared_ptr<Expr> unary();
-   std::shared_ptr<Expr> call();
-   std::shared_ptr<Expr> finish_call(std::shared_ptr<Expr> callee);
-   std::shared_ptr<Expr> primary();
+   Expr* expression();
+   Expr* or_expression();
+   Expr* and_expression();
+   Expr* equality();
+   Expr* comparison();
+   Expr* assignment();
+   Expr* term();
+   Expr* factor();
+   Expr* unary();
+   Expr* call();
+   Expr* finish_call(Expr* callee);
+   Expr* primary();
 
    template <typename... T> bool match(T... types);
    bool check(TokenType type);
    bool is_at_end();
-   Token advance();
-   Token peek();
-   Token previous();
-   Token consume(TokenType type, std::string message);
-   ParseError error(Token token, std::string message);
+   const Token& advance();
+   const Token& peek();
+   const Token& previous();
+   const Token& consume(TokenType type, std::string message);
+   ParseError error(const Token& token, std::string message);
    void synchronize();
-   std::shared_ptr<Stmt> statement();
-   std::shared_ptr<Stmt> for_statement();
-   std::shared_ptr<Stmt> if_statement();
-   std::shared_ptr<Stmt> while_statement();
-   std::shared_ptr<Stmt> print_statement();
-   std::shared_ptr<Stmt> return_statement();
-   std::shared_ptr<Stmt> expression_statement();
-   std::shared_ptr<Stmt> declaration();
-   std::shared_ptr<Stmt> var_declaration();
-   std::shared_ptr<Stmt> class_declaration();
-   std::shared_ptr<Function> function(std::string kind);
-   std::vector<std::shared_ptr<Stmt>> block();
+   Stmt* statement();
+   Stmt* for_statement();
+   Stmt* if_statement();
+   Stmt* while_statement();
+   Stmt* print_statement();
+   Stmt* return_statement();
+   Stmt* expression_statement();
+   Stmt* declaration();
+   Stmt* var_declaration();
+   Stmt* class_declaration();
+   Function* function(std::string kind);
+   std::vector<Stmt*> block();
 
 };
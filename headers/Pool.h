@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/*
+   Size-class allocator for the runtime's objects (every HeapObject allocates through it)
+   Sizes are rounded up to a multiple of 16 bytes, each size class has its own free list and carves new blocks out of 64 KB chunks.
+   The free lists are thread local, so allocating needs no lock. A block freed on another thread than the one that allocated it
+   just joins that thread's free list, so chunks are only given back once no block of any of them is live.
+   A thread that ends hands its free blocks and the rest of its chunks over to the threads that come after it (under a lock,
+   taken again only when a thread runs out of chunk), so running isolates on short lived threads doesn't leak.
+   Every chunk is registered under that lock too. The last thread using the pool to end frees them all, if every block
+   allocated from them was freed by then
+   Larger objects go to the general purpose allocator
+*/
+class Pool {
+public:
+   static void* allocate(std::size_t size);
+   static void free(void* block, std::size_t size);
+   static void print_stats(std::ostream& out); // * --alloc-stats, counts the current thread only
+
+   // * Counted by SpareVectors
+   static thread_local inline std::size_t vectors_reused = 0;
+   static thread_local inline std::size_t vectors_kept = 0;
+private:
+   static constexpr std::size_t GRANULE = 16;
+   static constexpr std::size_t CLASSES = 16; // * Up to 256 bytes
+   static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+   struct FreeBlock {
+      FreeBlock* next;
+   };
+   struct SizeClass {
+      FreeBlock* free = nullptr;
+      char* unused = nullptr;       // * The rest of the chunk blocks are carved from
+      char* unused_end = nullptr;
+      std::size_t allocations = 0;
+      std::size_t reused = 0;       // * Allocations served from the free list
+      std::size_t frees = 0;
+      std::size_t chunks = 0;
+   };
+   static thread_local SizeClass classes[CLASSES];
+
+   // * Made the first time a thread carves or frees a block, its destructor runs when the thread ends and leaves the thread's blocks to the others
+   struct Leftovers {
+      Leftovers();
+      ~Leftovers();
+   };
+   static thread_local Leftovers leftovers;
+   // * Everything below is guarded by orphans_mutex. Never destroyed, a thread can end after the statics are
+   static inline std::mutex orphans_mutex;
+   static inline std::vector<FreeBlock*>* const orphans = new std::vector<FreeBlock*>[CLASSES]; // * The free lists of threads that ended, adopted a whole list at a time
+   static inline std::vector<void*>* const chunks = new std::vector<void*>();
+   static inline std::size_t threads = 0;    // * Threads whose Leftovers are alive
+   static inline long long outstanding = 0;  // * Blocks allocated minus blocks freed, summed over the threads that ended
+private:
+   static void* carve(SizeClass& size_class, std::size_t block_size);
+   static void release_chunks();
+};
+
+/*
+   Empty vectors that keep their capacity, for objects made and dropped all the time:
+   a new Environment or instance starts with the buffer of one that went away, instead of growing a fresh one.
+   The spares are freed when their thread ends. Objects that go away later, while the main thread exits, start a new list
+   that is never freed: a thread local holding the list itself would be gone before them
+*/
+template <typename T>
+class SpareVectors {
+public:
+   static std::vector<T> take()
+   {
+      if (spares == nullptr or spares->empty()) {
+         return {};
+      }
+      std::vector<T> vector = std::move(spares->back());
+      spares->pop_back();
+      ++Pool::vectors_reused;
+      return vector;
+   }
+
+   // * Clears vector first, what its elements own may be freed (and give back vectors) before it is kept
+   static void give_back(std::vector<T>& vector)
+   {
+      vector.clear();
+      if (vector.capacity() == 0 or vector.capacity() > MAX_CAPACITY) {
+         return;
+      }
+      if (spares == nullptr) {
+         spares = new std::vector<std::vector<T>>();
+         static_cast<void>(&owner); // * Makes sure the thread frees them
+      }
+      if (spares->size() < MAX_SPARES) {
+         spares->push_back(std::move(vector));
+         ++Pool::vectors_kept;
+      }
+   }
+private:
+   static constexpr std::size_t MAX_SPARES = 1024;
+   static constexpr std::size_t MAX_CAPACITY = 64;
+   static thread_local inline std::vector<std::vector<T>>* spares = nullptr;
+
+   struct Owner {
+      ~Owner() { delete spares; spares = nullptr; }
+   };
+   static thread_local inline Owner owner;
+};
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Token.h"
+#include "Arena.h"
+#include "Statement.h"
+#include "Chunk.h"
+#include "SourceText.h"
+
+/*
+   One source and everything scanning and parsing it produced: the tokens, the arena holding the AST and the top level statements
+   AST nodes refer to the tokens instead of copying them, and functions and classes point into the AST,
+   so a Program has to outlive everything that was defined by running it.
+   The source is shared with the other Programs built from the same ProgramImage
+*/
+struct Program {
+   std::shared_ptr<const SourceText> source;
+   std::vector<Token> tokens;
+   Arena arena;
+   std::vector<Stmt*> statements;
+   std::vector<std::unique_ptr<VMFunction>> functions; // * The bytecode compiled from the statements, when running on the VM
+};
\ No newline at end of file
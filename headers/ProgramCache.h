@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Expr.h"
+#include "Statement.h"
+#include "Program.h"
+
+/*
+   Keeps a resolved and optimized program next to its source (script.lox -> script.loxc), so later runs of the same
+   source skip scanning, parsing, resolving and optimizing it.
+   The file starts with the format version, a stamp of the interpreter binary and a hash of the source,
+   a file whose header does not match what is running now is ignored and written again.
+   After the header come the tokens the AST refers to, as positions in the source, then the AST itself in pre-order with the Resolver's resolutions,
+   and last a checksum of those, so a damaged file is recompiled rather than run.
+   encode and decode do the same in memory, without the header, for the ProgramImages isolates share
+*/
+class ProgramCache : ExprVisitor, StmtVisitor {
+public:
+   Value visit_BinaryExpr  (Binary* expr)   override;
+   Value visit_GroupExpr   (Group* expr)    override;
+   Value visit_LiteralExpr (Literal* expr)  override;
+   Value visit_UnaryExpr   (Unary* expr)    override;
+   Value visit_VariableExpr(Variable* expr) override;
+   Value visit_AssignExpr  (Assign* expr)   override;
+   Value visit_LogicalExpr (Logical* expr)  override;
+   Value visit_CallExpr    (Call* expr)     override;
+   Value visit_GetExpr     (Get* expr)      override;
+   Value visit_SetExpr     (Set* expr)      override;
+   Value visit_ThisExpr    (This* expr)     override;
+   Value visit_SuperExpr   (Super* expr)    override;
+   Completion visit_ExpressionStmt (Expression* stmt) override;
+   Completion visit_PrintStmt      (Print* stmt)      override;
+   Completion visit_VarStmt        (Var* stmt)        override;
+   Completion visit_BlockStmt      (Block* stmt)      override;
+   Completion visit_IfStmt         (If* stmt)         override;
+   Completion visit_WhileStmt      (While* stmt)      override;
+   Completion visit_FunctionStmt   (Function* stmt)   override;
+   Completion visit_ReturnStmt     (Return* stmt)     override;
+   Completion visit_ClassStmt      (Class* stmt)      override;
+
+   ProgramCache() = default; // * Only for encode and decode
+   explicit ProgramCache(const std::string& source_path);
+   bool load(std::string_view source, Program& program); // * False when there is no valid cache, program is then left half built
+   void store(std::string_view source, const Program& program);
+   std::string encode(std::string_view source, const Program& program); // * Empty when the program has tokens from another source or does not fit the format
+   bool decode(std::string_view source, std::string_view data, Program& program); // * Like load
+
+private:
+   static constexpr std::uint32_t FORMAT_VERSION = 3;
+   enum Kind : std::uint8_t {
+      NONE, BINARY, GROUP, LITERAL, UNARY, VARIABLE, ASSIGN, LOGICAL, CALL, GET, SET, THIS, SUPER,
+      EXPRESSION, PRINT, VAR, BLOCK, IF, WHILE, FUNCTION, RETURN, CLASS
+   };
+   struct Corrupt {}; // * Thrown while loading a file that ends early or holds something the writer never writes
+   struct TooLarge {}; // * Thrown while storing more of something than a 32 bit count holds, the program is then not cached
+
+   const std::string path;
+   const std::uint64_t interpreter_stamp = 0;
+
+   // * Writing
+   std::string out;
+   std::unordered_map<const Token*, std::uint32_t> token_indices;
+   std::vector<const Token*> tokens;
+
+   // * Reading
+   const char* in = nullptr;
+   const char* end = nullptr;
+   Program* program = nullptr;
+private:
+   std::string header(std::string_view source) const;
+
+   template <typename T>
+   void write(T value);
+   void write_count(std::size_t count);
+   void write(const std::string& text);
+   void write(const Token& token);
+   void write(const Resolution& resolution);
+   void write(Expr* expr);
+   void write(Stmt* stmt);
+   void write(const std::vector<Stmt*>& statements);
+   void write_function(Function* function);
+
+   template <typename T>
+   T read();
+   std::uint32_t read_count();
+   std::string read_string();
+   const Token& read_token();
+   Resolution read_resolution();
+   Expr* read_expr();
+   Stmt* read_stmt();
+   std::vector<Stmt*> read_statements();
+   Function* read_function();
+};
\ No newline at end of file
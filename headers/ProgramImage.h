@@ -0,0 +1,16 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "SourceText.h"
+
+/*
+   A program compiled once that any number of Isolates can run, at the same time on different threads
+   A Program itself can't be shared: running it writes to its AST (property caches, resolved global slots,
+   the JIT's counters) and its string literals are reference counted without locks. The image is what is left without those:
+   the source and the resolved, optimized AST in the ProgramCache's format. Nothing writes to it once it is built,
+   every Isolate running it decodes its own Program from it, which skips scanning, parsing, resolving and optimizing
+*/
+struct ProgramImage {
+   std::shared_ptr<const SourceText> source;
+   std::string tree; // * ProgramCache::encode
+};
\ No newline at end of file
@@ -1,8 +1,9 @@
 #pragma once
 #include "Expr.h"
 #include "Statement.h"
-#include "Interpreter.h"
+#include "ErrorReporter.h"
 #include "map"
+#include <string_view>
 
 enum class FunctionType {
    NONE,
@@ -17,44 +18,51 @@ enum class ClassType {
    SUBCLASS
 };
 
+// * A variable in one of the Resolver's scopes, slot is its index in the matching runtime Environment
+struct ScopeVariable {
+   bool defined;
+   int slot;
+};
+
 class Resolver : ExprVisitor, StmtVisitor {
 public:
-   Resolver(Interpreter& interpreter);
-   std::any visit_BlockStmt     (std::shared_ptr<Block> stmt)      override;
-   std::any visit_VarStmt       (std::shared_ptr<Var> stmt)        override;
-   std::any visit_ExpressionStmt(std::shared_ptr<Expression> stmt) override;
-   std::any visit_IfStmt(std::shared_ptr<If> stmt)         override;
-   std::any visit_PrintStmt(std::shared_ptr<Print> stmt)      override;
-   std::any visit_ReturnStmt(std::shared_ptr<Return> stmt)    override;
-   std::any visit_WhileStmt(std::shared_ptr<While> stmt)     override;
-   std::any visit_FunctionStmt(std::shared_ptr<Function> stmt)   override;
-   std::any visit_ClassStmt(std::shared_ptr<Class> stmt) override;
-   std::any visit_VariableExpr(std::shared_ptr<Variable> expr)   override;
-   std::any visit_AssignExpr(std::shared_ptr<Assign> expr)   override;
-   std::any visit_BinaryExpr(std::shared_ptr<Binary> expr)       override;
-   std::any visit_CallExpr(std::shared_ptr<Call> expr)       override;
-   std::any visit_GroupExpr(std::shared_ptr<Group> expr)       override;
-   std::any visit_LiteralExpr(std::shared_ptr<Literal> expr)       override;
-   std::any visit_LogicalExpr(std::shared_ptr<Logical> expr)       override;
-   std::any visit_UnaryExpr(std::shared_ptr<Unary> expr)       override;
-   std::any visit_GetExpr(std::shared_ptr<Get> expr)       override;
-   std::any visit_SetExpr(std::shared_ptr<Set> expr)       override;
-   std::any visit_ThisExpr(std::shared_ptr<This> expr)       override;
-   std::any visit_SuperExpr(std::shared_ptr<Super> expr)       override;
+   Completion visit_BlockStmt     (Block* stmt)      override;
+   Completion visit_VarStmt       (Var* stmt)        override;
+   Completion visit_ExpressionStmt(Expression* stmt) override;
+   Completion visit_IfStmt(If* stmt)         override;
+   Completion visit_PrintStmt(Print* stmt)      override;
+   Completion visit_ReturnStmt(Return* stmt)    override;
+   Completion visit_WhileStmt(While* stmt)     override;
+   Completion visit_FunctionStmt(Function* stmt)   override;
+   Completion visit_ClassStmt(Class* stmt) override;
+   Value visit_VariableExpr(Variable* expr)   override;
+   Value visit_AssignExpr(Assign* expr)   override;
+   Value visit_BinaryExpr(Binary* expr)       override;
+   Value visit_CallExpr(Call* expr)       override;
+   Value visit_GroupExpr(Group* expr)       override;
+   Value visit_LiteralExpr(Literal* expr)       override;
+   Value visit_LogicalExpr(Logical* expr)       override;
+   Value visit_UnaryExpr(Unary* expr)       override;
+   Value visit_GetExpr(Get* expr)       override;
+   Value visit_SetExpr(Set* expr)       override;
+   Value visit_ThisExpr(This* expr)       override;
+   Value visit_SuperExpr(Super* expr)       override;
 
-   void resolve(std::vector<std::shared_ptr<Stmt>> statements);
+   explicit Resolver(ErrorReporter& errors) : errors(errors) {}
+   void resolve(std::vector<Stmt*> statements);
 private:
-   Interpreter& interpreter;
-   std::vector<std::map<std::string, bool>> scopes;
+   ErrorReporter& errors;
+   std::vector<std::map<std::string_view, ScopeVariable>> scopes;
    FunctionType current_function = FunctionType::NONE;
    ClassType current_class = ClassType::NONE;
 private:
-   void resolve(std::shared_ptr<Stmt> stmt);
-   void resolve(std::shared_ptr<Expr> expr);
+   void resolve(Stmt* stmt);
+   void resolve(Expr* expr);
    void begin_scope();
    void end_scope();
-   void declare(Token name);
-   void define(Token name);
-   void resolve_local(std::shared_ptr<Expr> expr, Token name);
-   void resolve_function(std::shared_ptr<Function> function, FunctionType type); 
+   void declare(const Token& name);
+   void define(const Token& name);
+   void define_internal(std::string_view name);
+   void resolve_local(Resolution& resolution, const Token& name);
+   void resolve_function(Function* function, FunctionType type); 
 };
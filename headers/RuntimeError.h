@@ -1,6 +1,7 @@
 #pragma once
 #include <stdexcept>
 #include "Token.h"
+#include "Value.h"
 #include <iostream>
 
 class RuntimeError : public std::runtime_error {
@@ -10,9 +11,4 @@ public:
   RuntimeError(const Token token, std::string_view message)
       : std::runtime_error(message.data()), token(token)
    {}
-};
-
-struct LoxReturn{
-public:
-   const std::any value;
 };
\ No newline at end of file
@@ -1,32 +1,44 @@
 #pragma once
+#include <cstddef>
+#include <optional>
 #include <vector>
-#include <unordered_map>
 #include <string>
+#include <string_view>
 #include "Token.h"
+#include "ErrorReporter.h"
 #include <iostream>
 
+/*
+   Turns source text into tokens
+   Runs of whitespace, comments, strings, identifiers and numbers are measured 16 bytes at a time with SSE2 where it is
+   available, the last bytes of the text (and every byte without SSE2) go through the plain loops.
+   Keywords are recognized with a perfect hash built at compile time, see Scanner.cpp
+   scan_declaration scans lazily for --stream: each call returns only the tokens of the next top level declaration
+*/
 class Scanner {
 public:
-   Scanner(const std::string& a_source);
+   Scanner(std::string_view a_source, ErrorReporter& errors);
    std::vector<Token> scan_tokens();
+   std::vector<Token> scan_declaration(); // * Ends with END_OF_FILE like scan_tokens, which is all it returns once the source is used up
 private:
-   static std::unordered_map<std::string, TokenType> keywords;
-   const std::string& source;
+   const std::string_view source; // * Scanned in place, the tokens point into it
+   ErrorReporter& errors;
    std::vector<Token> tokens;
-   unsigned int start = 0;
-   unsigned int current = 0;
+   std::size_t start = 0;
+   std::size_t current = 0;
    int line = 1;
+   std::optional<Token> lookahead; // * The first token of the next declaration, scan_declaration reads one token past the end of each
 private:
+   Token next_token();
    void scan_token();
    char advance() { return source[current++]; }
    bool is_at_end() { return current >= source.length(); }
-   void add_token(TokenType type);
-   void add_token(TokenType type, std::any literal);
+   void add_token(TokenType type, double number = 0);
    bool match(char expected);
    char peek();
    char peek_next();
    void string();
    void number();
    void identifier();
-   
-};
+   static TokenType keyword_type(std::string_view text);
+};
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/*
+   Measures how fast the Scanner turns source text into tokens (--bench-scanner)
+   It scans the given script, or without one a generated program of a few tens of megabytes with the usual mix of
+   keywords, identifiers, numbers, strings, comments and indentation, several times and reports the best run in MB/s
+*/
+class ScannerBenchmark {
+public:
+   static void run(const std::string& path);
+private:
+   static constexpr int RUNS = 5;
+   static constexpr std::size_t GENERATED_SIZE = 32 * 1024 * 1024;
+
+   static std::string generate(std::size_t size);
+};
\ No newline at end of file
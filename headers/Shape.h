@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include "Value.h"
+
+class LoxFunction;
+
+/*
+   A hidden class: maps field names to slots in an instance's field array
+   Instances that got the same fields in the same order share one Shape, adding a field moves an instance
+   along a transition to the next Shape. Every class owns the root (empty) Shape of its instances
+*/
+class Shape {
+public:
+   int slot_of(const std::string& name) const;
+   Ref<Shape> with_field(const std::string& name);
+   int size() const { return slots.size(); }
+
+   void retain() { ++ref_count; }
+   void release() { if (--ref_count == 0) { delete this; } }
+private:
+   std::unordered_map<std::string, int> slots;
+   std::unordered_map<std::string, Ref<Shape>> transitions;
+   int ref_count = 0;
+};
+
+/*
+   Inline cache of a Get or Set site, remembers what the name resolved to for the last few shapes seen there
+   An entry either holds the field's slot, or -1 and the method the name finds in the instance's class
+   (a shape belongs to exactly one class), or for a Set that adds a field the Shape the instance moves to.
+   Entries keep their shapes alive so a cached Shape can never be freed and its address reused.
+   A super.name site caches the same way, keyed on the root Shape of the superclass (which belongs to that class alone).
+   Method is the function type of the backend the cache belongs to
+*/
+template <typename Method>
+struct BasicPropertyCache {
+   static constexpr int SIZE = 4;
+
+   struct Entry {
+      Ref<Shape> shape;
+      Ref<Shape> transition;
+      int slot = -1;
+      Method* method = nullptr;
+   };
+
+   const Entry* find(const Shape* shape) const
+   {
+      for (int i = 0; i < count; ++i) {
+         if (entries[i].shape.get() == shape) { return &entries[i]; }
+      }
+      return nullptr;
+   }
+
+   // * Once full the site is megamorphic, it keeps its entries and misses go the slow way
+   void add(Entry entry)
+   {
+      if (count < SIZE) { entries[count++] = std::move(entry); }
+   }
+
+   Entry entries[SIZE];
+   int count = 0;
+};
+
+using PropertyCache = BasicPropertyCache<LoxFunction>;
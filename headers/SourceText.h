@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/*
+   The text of a program: a script file mapped read-only into memory, or a line typed into the REPL
+   Files are scanned where they lie instead of being copied into strings first,
+   the Program compiled from the text owns it so anything pointing into it stays valid as long as the program
+*/
+class SourceText {
+public:
+   explicit SourceText(std::string text);
+   static std::unique_ptr<SourceText> open(const std::string& path); // * nullptr when the file can't be read, errno says why
+   ~SourceText();
+   SourceText(const SourceText&) = delete;
+   SourceText& operator=(const SourceText&) = delete;
+
+   std::string_view view() const { return text; }
+   void release_before(std::size_t offset); // * Gives the memory of a mapped file's first offset bytes back, they are read again if touched
+private:
+   SourceText() = default;
+   std::string owned;          // * REPL lines, and files that can't be mapped like pipes
+   void* mapping = nullptr;
+   std::size_t mapping_size = 0;
+   std::size_t released = 0;   // * How much of the mapping release_before already dropped
+   std::string_view text;
+};
\ No newline at end of file
@@ -12,83 +12,104 @@ struct While;
 struct Function;
 struct Return;
 struct Class;
+struct FunctionBody;
+class JitFunction;
+
+// * How a statement finished: either normally or by hitting a return, which carries its value up to the enclosing call
+struct Completion {
+  enum Type { NORMAL, RETURN };
+  Type type = NORMAL;
+  Value value;
+};
+
+// * What the Jit knows about a function: how hot it got while interpreted and, once it tried compiling it, how that went
+struct JitProfile {
+  enum State { COLD, COMPILED, REJECTED };
+  State state = COLD;
+  int hotness = 0;              // * Calls plus loop iterations
+  JitFunction* code = nullptr;
+};
 
 struct StmtVisitor {
-  virtual std::any visit_BlockStmt      (std::shared_ptr<Block> stmt)      = 0;
-  virtual std::any visit_ExpressionStmt (std::shared_ptr<Expression> stmt) = 0;
-  virtual std::any visit_PrintStmt      (std::shared_ptr<Print> stmt)      = 0;
-  virtual std::any visit_VarStmt        (std::shared_ptr<Var> stmt)        = 0;
-  virtual std::any visit_IfStmt         (std::shared_ptr<If> stmt)         = 0;
-  virtual std::any visit_WhileStmt      (std::shared_ptr<While> stmt)      = 0;
-  virtual std::any visit_FunctionStmt   (std::shared_ptr<Function> stmt)   = 0;
-  virtual std::any visit_ReturnStmt     (std::shared_ptr<Return> stmt)     = 0;
-  virtual std::any visit_ClassStmt      (std::shared_ptr<Class> stmt)      = 0;
+  virtual Completion visit_BlockStmt      (Block* stmt)      = 0;
+  virtual Completion visit_ExpressionStmt (Expression* stmt) = 0;
+  virtual Completion visit_PrintStmt      (Print* stmt)      = 0;
+  virtual Completion visit_VarStmt        (Var* stmt)        = 0;
+  virtual Completion visit_IfStmt         (If* stmt)         = 0;
+  virtual Completion visit_WhileStmt      (While* stmt)      = 0;
+  virtual Completion visit_FunctionStmt   (Function* stmt)   = 0;
+  virtual Completion visit_ReturnStmt     (Return* stmt)     = 0;
+  virtual Completion visit_ClassStmt      (Class* stmt)      = 0;
   virtual ~StmtVisitor() = default;
 };
 
 struct Stmt {
-  virtual std::any accept(StmtVisitor& visitor) = 0;
+  virtual Completion accept(StmtVisitor& visitor) = 0;
 };
 
-struct Block: Stmt, public std::enable_shared_from_this<Block> {
-  Block(std::vector<std::shared_ptr<Stmt>> statements);
-  std::any accept(StmtVisitor& visitor) override;
-  const std::vector<std::shared_ptr<Stmt>> statements;
+struct Block: Stmt {
+  Block(std::vector<Stmt*> statements);
+  Completion accept(StmtVisitor& visitor) override;
+  const std::vector<Stmt*> statements;
 };
 
-struct Expression: Stmt, public std::enable_shared_from_this<Expression> {
-  Expression(std::shared_ptr<Expr> expression);
-  std::any accept(StmtVisitor& visitor) override;
-  const std::shared_ptr<Expr> expression;
+struct Expression: Stmt {
+  Expression(Expr* expression);
+  Completion accept(StmtVisitor& visitor) override;
+  Expr* const expression;
 };
 
-struct Print: Stmt, public std::enable_shared_from_this<Print> {
-  Print(std::shared_ptr<Expr> expression);
-  std::any accept(StmtVisitor& visitor) override;
-  const std::shared_ptr<Expr> expression;
+struct Print: Stmt {
+  Print(Expr* expression);
+  Completion accept(StmtVisitor& visitor) override;
+  Expr* const expression;
 };
 
-struct Var: Stmt, public std::enable_shared_from_this<Var> {
-  Var(Token name, std::shared_ptr<Expr> initializer);
-  std::any accept(StmtVisitor& visitor) override;
-  const Token name;
-  const std::shared_ptr<Expr> initializer;
+struct Var: Stmt {
+  Var(const Token& name, Expr* initializer);
+  Completion accept(StmtVisitor& visitor) override;
+  const Token& name;
+  Expr* const initializer;
 };
 
-struct If: Stmt, public std::enable_shared_from_this<If> {
-  If(std::shared_ptr<Expr> condition, std::shared_ptr<Stmt> then_branch, std::shared_ptr<Stmt> else_branch);
-  std::any accept(StmtVisitor& visitor) override;
-  const std::shared_ptr<Expr> condition;
-  const std::shared_ptr<Stmt> then_branch;
-  const std::shared_ptr<Stmt> else_branch;
+struct If: Stmt {
+  If(const Token& keyword, Expr* condition, Stmt* then_branch, Stmt* else_branch);
+  Completion accept(StmtVisitor& visitor) override;
+  const Token& keyword;
+  Expr* const condition;
+  Stmt* const then_branch;
+  Stmt* const else_branch;
 };
 
-struct While: Stmt, public std::enable_shared_from_this<While> {
-  While(std::shared_ptr<Expr> condition, std::shared_ptr<Stmt> body);
-  std::any accept(StmtVisitor& visitor) override;
-  const std::shared_ptr<Expr> condition;
-  const std::shared_ptr<Stmt> body;
+struct While: Stmt {
+  While(const Token& keyword, Expr* condition, Stmt* body);
+  Completion accept(StmtVisitor& visitor) override;
+  const Token& keyword; // * "for" for the loops a for statement turns into
+  Expr* const condition;
+  Stmt* const body;
 };
 
-struct Function: Stmt, public std::enable_shared_from_this<Function> {
-  Function( Token name, std::vector<Token> params, std::vector<std::shared_ptr<Stmt>> body);
-  std::any accept(StmtVisitor& visitor) override;
-  const Token name;
-  const std::vector<Token> params;
-  const std::vector<std::shared_ptr<Stmt>> body;
+struct Function: Stmt {
+  Function( const Token& name, std::vector<const Token*> params, std::vector<Stmt*> body);
+  Completion accept(StmtVisitor& visitor) override;
+  const Token& name;
+  const std::vector<const Token*> params;
+  const std::vector<Stmt*> body;
+  FunctionBody* compiled_body = nullptr; // * Set when the ClosureCompiler compiled the body, calls then run that instead
+  JitProfile jit;
 };
 
-struct Return: Stmt, public std::enable_shared_from_this<Return> {
-  Return(Token keyword, std::shared_ptr<Expr> value);
-  std::any accept(StmtVisitor& visitor) override;
-  const Token keyword;
-  const std::shared_ptr<Expr> value;  
+struct Return: Stmt {
+  Return(const Token& keyword, Expr* value);
+  Completion accept(StmtVisitor& visitor) override;
+  const Token& keyword;
+  Expr* const value;  
 };
 
-struct Class: Stmt, public std::enable_shared_from_this<Class> {
-  Class(Token name, std::shared_ptr<Variable> superclass, std::vector<std::shared_ptr<Function>> methods);
-  std::any accept(StmtVisitor& visitor) override;
-  const Token name;
-  const std::shared_ptr<Variable> superclass;
-  const std::vector<std::shared_ptr<Function>> methods;
+struct Class: Stmt {
+  Class(const Token& name, Variable* superclass, std::vector<Function*> methods);
+  Completion accept(StmtVisitor& visitor) override;
+  const Token& name;
+  Variable* const superclass;
+  const std::vector<Function*> methods;
 };
@@ -1,6 +1,6 @@
 #pragma once
 #include <string>
-#include <any>
+#include <string_view>
 
 enum TokenType
 {
@@ -24,15 +24,17 @@ enum TokenType
    END_OF_FILE
 };
 
+// * Small (32 bytes) and trivially copyable: the lexeme is a view into the Program's source text, which outlives the tokens
 class Token
 {
    public:
-   const TokenType type;       
-   std::string lexeme;  // The group of characters
-   std::any literal;    // The actual value that the token is holding, if any 
-   const int line; // For better errror reporting
+   TokenType type;       
+   int line; // For better errror reporting
+   std::string_view lexeme;  // The group of characters
+   double number = 0;        // * The value of a NUMBER token
 
-   Token(TokenType a_type, std::string a_lexeme, std::any a_literal, int a_line);
+   Token(TokenType a_type, std::string_view a_lexeme, int a_line, double a_number = 0);
+   std::string_view string_value() const { return lexeme.substr(1, lexeme.size() - 2); } // * A STRING token's value, without the quotes
    std::string to_string() const;
 };
 
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Value.h"
+#include "Token.h"
+#include "Chunk.h"
+#include "VMObjects.h"
+#include "ErrorReporter.h"
+#include "Heap.h"
+#include <ostream>
+
+/*
+   Runs the bytecode the Compiler produced on a stack of values
+   A call's frame starts at the callee's slot: slot 0 holds the closure being called (the receiver for methods),
+   the arguments follow and then the locals and temporaries of the function
+*/
+class VM {
+public:
+   VM(std::ostream& out, ErrorReporter& errors, Heap& heap); // * Where print writes, runtime errors go and objects are collected
+   ~VM();
+   VM(const VM&) = delete;
+   VM& operator=(const VM&) = delete;
+
+   void interpret(VMFunction* script);
+   int global_slot(const std::string& name); // * The Compiler asks for the slot of a global by name, a name always keeps its slot
+
+private:
+   struct CallFrame {
+      Ref<VMClosure> closure;
+      const std::uint8_t* ip;
+      Value* slots;
+      Value* stack_base; // * Where the result goes, below slots when the call left something else under the callee
+   };
+
+   struct Global {
+      Value value;
+      bool defined = false;
+   };
+
+   static constexpr int FRAMES_MAX = 16384;
+   static constexpr int STACK_MAX = FRAMES_MAX * 64;
+   static constexpr int FRAME_SLOTS = 1024; // * Room every call must leave: locals, arguments and temporaries
+
+   std::ostream& out;
+   ErrorReporter& errors;
+   Heap& heap;
+   Value* stack = nullptr;
+   Value* stack_top = nullptr;
+   std::vector<CallFrame> frames;
+   std::vector<Ref<VMUpvalue>> open_upvalues; // * Sorted by the stack slot they point to
+   std::vector<Global> globals;
+   std::unordered_map<std::string, int> global_slots;
+
+private:
+   void run();
+   void push(Value value) { *stack_top++ = std::move(value); }
+   Value pop() { return std::move(*--stack_top); }
+   void pop_to(Value* base);
+   void reset_stack();
+
+   void call_value(Value* callee, int argument_count, Value* stack_base, const Token& token);
+   void call_closure(Ref<VMClosure> closure, Value* slots, int argument_count, Value* stack_base, const Token& token);
+   Value call_native(Value* callee, int argument_count, const Token& token);
+   Ref<VMUpvalue> capture_upvalue(Value* local);
+   void close_upvalues(Value* last);
+   void define_global(const std::string& name, Value value);
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Value.h"
+#include "Shape.h"
+#include "Chunk.h"
+#include "Token.h"
+
+/*
+   The runtime objects of the VM, the counterparts of LoxFunction, LoxClass and LoxInstance
+   They carry the same tags, so values print and compare the same way on both backends
+*/
+
+// * A variable captured by a closure: points at its stack slot while the variable is in scope, then holds the value itself
+class VMUpvalue : public HeapObject {
+public:
+   explicit VMUpvalue(Value* location) : location(location) { track(); }
+   Value* location;
+   Value closed;
+
+   void close() { closed = *location; location = &closed; }
+   void trace(Tracer& tracer) override { tracer.visit(closed); }
+   void clear_references() override { closed = nullptr; }
+};
+
+class VMClosure : public Object {
+public:
+   static constexpr ValueType value_type = ValueType::FUNCTION;
+   VMClosure(VMFunction* function, Value receiver = nullptr);
+   VMFunction* const function;
+   std::vector<Ref<VMUpvalue>> upvalues;
+   Value receiver; // * The instance a bound method runs on, nil for plain functions and unbound methods
+
+   Ref<VMClosure> bind(Value instance);
+   std::string to_string() override;
+   void trace(Tracer& tracer) override;
+   void clear_references() override;
+};
+
+class VMClass : public Object {
+public:
+   static constexpr ValueType value_type = ValueType::CLASS;
+   explicit VMClass(std::string name);
+   const std::string name;
+   const Ref<Shape> instance_shape{new Shape()};
+   Ref<VMClosure> initializer;
+
+   void inherit(VMClass* superclass);
+   void add_method(const std::string& name, Ref<VMClosure> method);
+   VMClosure* find_method(const std::string& name);
+   VMClosure* find_method(std::string_view name, VMPropertyCache& cache); // * For super.name, cached on instance_shape
+   int arity();
+   std::string to_string() override { return name; }
+   void trace(Tracer& tracer) override;
+   void clear_references() override;
+private:
+   std::unordered_map<std::string, Ref<VMClosure>> methods; // * Flattened like LoxClass's
+};
+
+class VMInstance : public Object {
+public:
+   static constexpr ValueType value_type = ValueType::INSTANCE;
+   explicit VMInstance(Ref<VMClass> vm_class);
+   ~VMInstance();
+   std::string to_string() override;
+   Value get(const Token& name, VMPropertyCache& cache);
+   void set(const Token& name, Value value, VMPropertyCache& cache);
+   VMClosure* find_method(std::string_view name, VMPropertyCache& cache);
+   void trace(Tracer& tracer) override;
+   void clear_references() override;
+
+private:
+   Ref<VMClass> vm_class;
+   Ref<Shape> shape;
+   std::vector<Value> fields;
+private:
+   const VMPropertyCache::Entry& lookup(std::string_view name, VMPropertyCache& cache, VMPropertyCache::Entry& miss);
+};
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "Heap.h"
+
+enum class ValueType : std::uint8_t
+{
+   NIL, BOOL, NUMBER,
+
+   // Everything from here on points to a heap allocated Object
+   STRING, NATIVE, FUNCTION, CLASS, INSTANCE
+};
+
+/*
+   Base of every heap allocated runtime value (strings, functions, classes, instances).
+   Objects are reference counted intrusively so that a Value only needs to carry a raw pointer, see HeapObject
+*/
+class Object : public HeapObject {
+public:
+   virtual std::string to_string() = 0;
+};
+
+// * A typed owning pointer to a HeapObject, used wherever C++ code holds onto runtime objects
+template <typename T>
+class Ref {
+public:
+   Ref() = default;
+   Ref(std::nullptr_t) {}
+   Ref(T* ptr) : ptr(ptr) { if (ptr) { ptr->retain(); } }
+   Ref(const Ref& other) : Ref(other.ptr) {}
+   Ref(Ref&& other) noexcept : ptr(other.ptr) { other.ptr = nullptr; }
+   template <typename U> Ref(const Ref<U>& other) : Ref(other.get()) {}
+   ~Ref() { if (ptr) { ptr->release(); } }
+
+   Ref& operator=(Ref other) noexcept { std::swap(ptr, other.ptr); return *this; }
+
+   T* get() const { return ptr; }
+   T* operator->() const { return ptr; }
+   T& operator*() const { return *ptr; }
+   explicit operator bool() const { return ptr != nullptr; }
+   bool operator==(std::nullptr_t) const { return ptr == nullptr; }
+   bool operator!=(std::nullptr_t) const { return ptr != nullptr; }
+private:
+   T* ptr = nullptr;
+};
+
+class LoxString : public Object {
+public:
+   static constexpr ValueType value_type = ValueType::STRING;
+   explicit LoxString(std::string value) : value(std::move(value)) {}
+   std::string to_string() override { return value; }
+   const std::string value;
+};
+
+/*
+   A Lox value: a one byte tag plus an 8 byte payload (16 bytes in total)
+   nil, booleans and numbers are stored inline, everything else is a pointer to an Object
+   The tag says what the value is to Lox, which Object subclass is behind a function, class or instance depends on the backend that made it
+*/
+class Value {
+public:
+   Value() : tag(ValueType::NIL), bits(0) {}
+   Value(std::nullptr_t) : Value() {}
+   Value(bool boolean) : tag(ValueType::BOOL), bits(boolean) {}
+   Value(double number) : tag(ValueType::NUMBER), number(number) {}
+   Value(std::string string) : Value(Ref<LoxString>(new LoxString(std::move(string)))) {}
+   Value(const char* string) : Value(std::string(string)) {}
+
+   template <typename T>
+   Value(const Ref<T>& ref)
+      : tag(ref ? T::value_type : ValueType::NIL), object(ref.get())
+   {
+      if (object) { object->retain(); }
+   }
+
+   Value(const Value& other) : tag(other.tag), bits(other.bits)
+   {
+      if (is_object()) { object->retain(); }
+   }
+   Value(Value&& other) noexcept : tag(other.tag), bits(other.bits)
+   {
+      other.tag = ValueType::NIL;
+   }
+   Value& operator=(Value other) noexcept
+   {
+      std::swap(tag, other.tag);
+      std::swap(bits, other.bits);
+      return *this;
+   }
+   ~Value() { if (is_object()) { object->release(); } }
+
+   ValueType type() const { return tag; }
+   bool is_nil()      const { return tag == ValueType::NIL; }
+   bool is_bool()     const { return tag == ValueType::BOOL; }
+   bool is_number()   const { return tag == ValueType::NUMBER; }
+   bool is_string()   const { return tag == ValueType::STRING; }
+   bool is_function() const { return tag == ValueType::FUNCTION; }
+   bool is_class()    const { return tag == ValueType::CLASS; }
+   bool is_instance() const { return tag == ValueType::INSTANCE; }
+   bool is_callable() const { return tag == ValueType::NATIVE || tag == ValueType::FUNCTION || tag == ValueType::CLASS; }
+   bool is_object()   const { return tag >= ValueType::STRING; }
+
+   bool as_bool()     const { return bits != 0; }
+   double as_number() const { return number; }
+   const std::string& as_string() const { return static_cast<LoxString*>(object)->value; }
+
+   // * Only call this after checking the tag, the cast is unchecked
+   template <typename T> T* as() const { return static_cast<T*>(object); }
+
+   bool is_truthy() const;
+   bool equals(const Value& other) const;
+   std::string to_string() const;
+
+private:
+   ValueType tag;
+   union {
+      double number;
+      Object* object;
+      std::uint64_t bits;
+   };
+};
+
+static_assert(sizeof(Value) == 16, "Value should stay a 16 byte tag + payload pair");
@@ -0,0 +1,65 @@
+#!/bin/sh
+# Runs every script in this directory (make test): what it prints on each backend must match its .expected file.
+# Also checks the JIT deoptimizes what a .deopts file lists, that gc_ scripts get cycles collected
+# and that a cache (.loxc) that is cut short, damaged or stale is compiled again instead of run
+lox=${1:-./main}
+tests=$(dirname "$0")
+scratch=$(mktemp -d)
+failures=0
+
+fail()
+{
+   echo "FAIL $*"
+   failures=$((failures + 1))
+}
+
+# What a run prints, without the line naming the script
+output()
+{
+   "$lox" "$@" 2>/dev/null | grep -v '^Running from file at:'
+}
+
+for script in "$tests"/*.lox; do
+   expected="${script%.lox}.expected"
+   for mode in "" --no-jit --vm --closures; do
+      output --no-cache $mode "$script" | cmp -s - "$expected" || fail "$script $mode"
+   done
+
+   cache="$scratch/test.loxc"
+   cp "$script" "$scratch/test.lox"
+   output "$scratch/test.lox" | cmp -s - "$expected" || fail "$script, writing its cache"
+   [ -f "$cache" ] || fail "$script, no cache written"
+   output "$scratch/test.lox" | cmp -s - "$expected" || fail "$script, from its cache"
+
+   size=$(wc -c < "$cache")
+   head -c $((size / 2)) "$cache" > "$scratch/cut" && mv "$scratch/cut" "$cache"
+   output "$scratch/test.lox" | cmp -s - "$expected" || fail "$script, from a cache cut short"
+
+   printf '\377\377\377\377' | dd of="$cache" bs=1 seek=$((size / 2)) conv=notrunc 2>/dev/null
+   output "$scratch/test.lox" | cmp -s - "$expected" || fail "$script, from a damaged cache"
+
+   echo 'print "edited";' >> "$scratch/test.lox"
+   { cat "$expected"; echo edited; } > "$scratch/edited"
+   output "$scratch/test.lox" | cmp -s - "$scratch/edited" || fail "$script, from a stale cache"
+   rm -f "$cache"
+done
+
+if [ "$(uname -m)" = x86_64 ] && [ "$(uname -s)" = Linux ]; then
+   for deopts in "$tests"/*.deopts; do
+      script="${deopts%.deopts}.lox"
+      "$lox" --no-cache --jit-log "$script" 2>&1 >/dev/null | grep deoptimized | cmp -s - "$deopts" || fail "$script --jit-log"
+   done
+fi
+
+for script in "$tests"/gc_*.lox; do
+   for mode in "" --vm --closures; do
+      "$lox" --no-cache $mode --gc-stats "$script" 2>&1 >/dev/null | grep -q "freed [1-9]" || fail "$script $mode --gc-stats"
+   done
+done
+
+rm -rf "$scratch"
+if [ $failures -ne 0 ]; then
+   echo "$failures failed"
+   exit 1
+fi
+echo "all tests passed"